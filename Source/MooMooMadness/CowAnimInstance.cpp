@@ -0,0 +1,93 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CowAnimInstance.h"
+
+#include "MooMooMadnessCharacter.h"
+#include "Animation/AnimMontage.h"
+
+void UCowAnimInstance::NativeInitializeAnimation()
+{
+	Super::NativeInitializeAnimation();
+
+	//Reinitializing keeps the delegates, don't bind twice
+	OnMontageStarted.AddUniqueDynamic(this, &UCowAnimInstance::OnMontageStartedEvent);
+	OnMontageEnded.AddUniqueDynamic(this, &UCowAnimInstance::OnMontageEndedEvent);
+}
+
+void UCowAnimInstance::SetTrackedMontage(ECowMontage Montage, UAnimMontage* Asset)
+{
+	if (Montage >= ECowMontage::MAX || TrackedMontages[(uint8)Montage] == Asset)
+	{
+		return;
+	}
+
+	TrackedMontages[(uint8)Montage] = Asset;
+	MontagePlayCounts[(uint8)Montage] = Asset && Montage_IsActive(Asset) ? 1 : 0;
+	UpdateMontageFlags();
+}
+
+int32 UCowAnimInstance::FindTrackedMontage(const UAnimMontage* Montage) const
+{
+	for (int32 Index = 0; Index < (uint8)ECowMontage::MAX; Index++)
+	{
+		if (Montage && TrackedMontages[Index] == Montage)
+		{
+			return Index;
+		}
+	}
+	return INDEX_NONE;
+}
+
+void UCowAnimInstance::OnMontageStartedEvent(UAnimMontage* Montage)
+{
+	const int32 Index = FindTrackedMontage(Montage);
+	if (Index != INDEX_NONE)
+	{
+		MontagePlayCounts[Index]++;
+		UpdateMontageFlags();
+	}
+}
+
+void UCowAnimInstance::OnMontageEndedEvent(UAnimMontage* Montage, bool bInterrupted)
+{
+	const int32 Index = FindTrackedMontage(Montage);
+	if (Index != INDEX_NONE)
+	{
+		MontagePlayCounts[Index] = FMath::Max(MontagePlayCounts[Index] - 1, 0);
+		UpdateMontageFlags();
+	}
+}
+
+void UCowAnimInstance::UpdateMontageFlags()
+{
+	bIsChargingHeadbutt = IsMontagePlaying(ECowMontage::HeadbuttCharge);
+	bIsHeadbutting = IsMontagePlaying(ECowMontage::Headbutt);
+	bIsJumping = IsMontagePlaying(ECowMontage::Jump);
+	bIsKicking = IsMontagePlaying(ECowMontage::Kick);
+}
+
+void UCowAnimInstance::NativeUpdateAnimation(float DeltaSeconds)
+{
+	Super::NativeUpdateAnimation(DeltaSeconds);
+
+	//Everything the worker thread needs from the owner, gathered while touching actors is still safe
+	if (const AMooMooMadnessCharacter* Cow = Cast<AMooMooMadnessCharacter>(TryGetPawnOwner()))
+	{
+		const UCowMovementComponent* Movement = Cow->GetCowMovement();
+		GameThreadVelocity = Cow->GetVelocity();
+		bGameThreadFalling = Movement && Movement->IsFalling();
+		bGameThreadSprinting = Movement && Movement->IsSprinting();
+		bGameThreadStunned = Cow->IsStunned();
+	}
+}
+
+void UCowAnimInstance::NativeThreadSafeUpdateAnimation(float DeltaSeconds)
+{
+	Super::NativeThreadSafeUpdateAnimation(DeltaSeconds);
+
+	GroundSpeed = GameThreadVelocity.Size2D();
+	bIsFalling = bGameThreadFalling;
+	bIsSprinting = bGameThreadSprinting;
+	bIsStunned = bGameThreadStunned;
+}
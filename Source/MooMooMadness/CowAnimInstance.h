@@ -0,0 +1,94 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Animation/AnimInstance.h"
+#include "CowAnimInstance.generated.h"
+
+class UAnimMontage;
+
+/** Montages the cow's gameplay code cares about */
+UENUM(BlueprintType)
+enum class ECowMontage : uint8
+{
+	HeadbuttCharge,
+	Headbutt,
+	Jump,
+	Kick,
+
+	MAX UMETA(Hidden)
+};
+
+/**
+ * Anim instance for the cow. Montage flags are kept up to date from the montage started and ended events,
+ * so gameplay reads a bool instead of searching the active montage instances, and the owner's movement state
+ * is copied once per frame on the game thread so the anim graph can update on a worker thread.
+ */
+UCLASS()
+class MOOMOOMADNESS_API UCowAnimInstance : public UAnimInstance
+{
+	GENERATED_BODY()
+
+public:
+	/** Tells the instance which montage asset stands for each ECowMontage, called by the owning cow */
+	void SetTrackedMontage(ECowMontage Montage, UAnimMontage* Asset);
+
+	/** Whether a tracked montage is playing, safe to call from gameplay without touching the montage system */
+	FORCEINLINE bool IsMontagePlaying(ECowMontage Montage) const { return MontagePlayCounts[(uint8)Montage] > 0; }
+
+protected:
+	virtual void NativeInitializeAnimation() override;
+	virtual void NativeUpdateAnimation(float DeltaSeconds) override;
+	virtual void NativeThreadSafeUpdateAnimation(float DeltaSeconds) override;
+
+	//Montage flags for the anim graph, mirrors IsMontagePlaying
+	UPROPERTY(BlueprintReadOnly, Transient, Category = "Montages")
+	bool bIsChargingHeadbutt = false;
+
+	UPROPERTY(BlueprintReadOnly, Transient, Category = "Montages")
+	bool bIsHeadbutting = false;
+
+	UPROPERTY(BlueprintReadOnly, Transient, Category = "Montages")
+	bool bIsJumping = false;
+
+	UPROPERTY(BlueprintReadOnly, Transient, Category = "Montages")
+	bool bIsKicking = false;
+
+	//Locomotion values, written on the worker thread from the game thread copies below
+	UPROPERTY(BlueprintReadOnly, Transient, Category = "Locomotion")
+	float GroundSpeed = 0.f;
+
+	UPROPERTY(BlueprintReadOnly, Transient, Category = "Locomotion")
+	bool bIsFalling = false;
+
+	UPROPERTY(BlueprintReadOnly, Transient, Category = "Locomotion")
+	bool bIsSprinting = false;
+
+	UPROPERTY(BlueprintReadOnly, Transient, Category = "Locomotion")
+	bool bIsStunned = false;
+
+private:
+	UFUNCTION()
+	void OnMontageStartedEvent(UAnimMontage* Montage);
+
+	UFUNCTION()
+	void OnMontageEndedEvent(UAnimMontage* Montage, bool bInterrupted);
+
+	/** Index of a tracked montage, INDEX_NONE for any other montage */
+	int32 FindTrackedMontage(const UAnimMontage* Montage) const;
+
+	void UpdateMontageFlags();
+
+	UPROPERTY(Transient)
+	TObjectPtr<UAnimMontage> TrackedMontages[(uint8)ECowMontage::MAX];
+
+	//Instances of each tracked montage that started and haven't ended, a restart starts the new one before ending the old
+	int32 MontagePlayCounts[(uint8)ECowMontage::MAX] = {};
+
+	//Copied from the owner on the game thread, read by NativeThreadSafeUpdateAnimation
+	FVector GameThreadVelocity = FVector::ZeroVector;
+	bool bGameThreadFalling = false;
+	bool bGameThreadSprinting = false;
+	bool bGameThreadStunned = false;
+};
@@ -0,0 +1,97 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CowAssetPreloadSubsystem.h"
+
+#include "CowGameData.h"
+#include "Engine/AssetManager.h"
+#include "Engine/StreamableManager.h"
+#include "Engine/World.h"
+
+static const FName MenuBundle = "Menu";
+static const FName MatchBundle = "Match";
+
+void UCowAssetPreloadSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	PostLoadMapHandle = FCoreUObjectDelegates::PostLoadMapWithWorld.AddUObject(this, &UCowAssetPreloadSubsystem::OnPostLoadMap);
+}
+
+void UCowAssetPreloadSubsystem::Deinitialize()
+{
+	FCoreUObjectDelegates::PostLoadMapWithWorld.Remove(PostLoadMapHandle);
+
+	if (MatchBundleHandle.IsValid())
+	{
+		MatchBundleHandle->CancelHandle();
+	}
+	if (MatchClassesHandle.IsValid())
+	{
+		MatchClassesHandle->CancelHandle();
+	}
+
+	Super::Deinitialize();
+}
+
+TArray<FPrimaryAssetId> UCowAssetPreloadSubsystem::GetGameDataIds() const
+{
+	TArray<FPrimaryAssetId> GameDataIds;
+	UAssetManager::Get().GetPrimaryAssetIdList(UCowGameData::PrimaryAssetType, GameDataIds);
+	return GameDataIds;
+}
+
+void UCowAssetPreloadSubsystem::OnPostLoadMap(UWorld* LoadedWorld)
+{
+	if (!LoadedWorld || LoadedWorld->GetGameInstance() != GetGameInstance())
+	{
+		return;
+	}
+
+	const bool bIsMenu = UWorld::RemovePIEPrefix(LoadedWorld->GetOutermost()->GetName()) == MenuMap.ToSoftObjectPath().GetLongPackageName();
+	UAssetManager& AssetManager = UAssetManager::Get();
+	const TArray<FPrimaryAssetId> GameDataIds = GetGameDataIds();
+
+	if (bIsMenu)
+	{
+		AssetManager.ChangeBundleStateForPrimaryAssets(GameDataIds, { MenuBundle }, {});
+		PreloadMatchAssets();
+	}
+	else
+	{
+		//The menu is gone until the match ends
+		AssetManager.ChangeBundleStateForPrimaryAssets(GameDataIds, { MatchBundle }, { MenuBundle });
+	}
+}
+
+void UCowAssetPreloadSubsystem::PreloadMatchAssets()
+{
+	if (bMatchPreloadStarted)
+	{
+		return;
+	}
+	bMatchPreloadStarted = true;
+
+	MatchBundleHandle = UAssetManager::Get().LoadPrimaryAssets(GetGameDataIds(), { MatchBundle }, FStreamableDelegate(), FStreamableManager::AsyncLoadLowPriority);
+
+	TArray<FSoftObjectPath> Paths;
+	for (const TSoftClassPtr<AActor>& MatchClass : MatchClasses)
+	{
+		if (!MatchClass.IsNull())
+		{
+			Paths.Add(MatchClass.ToSoftObjectPath());
+		}
+	}
+	if (Paths.Num() > 0)
+	{
+		MatchClassesHandle = UAssetManager::GetStreamableManager().RequestAsyncLoad(Paths, FStreamableDelegate(), FStreamableManager::AsyncLoadLowPriority);
+	}
+}
+
+bool UCowAssetPreloadSubsystem::IsMatchPreloaded() const
+{
+	//No handle means there was nothing left to load
+	const bool bBundleLoaded = !MatchBundleHandle.IsValid() || MatchBundleHandle->HasLoadCompleted();
+	const bool bClassesLoaded = !MatchClassesHandle.IsValid() || MatchClassesHandle->HasLoadCompleted();
+	return bMatchPreloadStarted && bBundleLoaded && bClassesLoaded;
+}
@@ -0,0 +1,55 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "CowAssetPreloadSubsystem.generated.h"
+
+struct FStreamableHandle;
+
+/**
+ * Keeps the asset bundles of every UCowGameData in step with the map that is loaded.
+ * The menu map holds the Menu bundle and starts loading the Match bundle in the background, along with MatchClasses from
+ * config. Loading the cow and destroyable classes pulls in the input, montages and sounds they hard reference, so the match
+ * map only has to find them in memory. Match maps drop the Menu bundle. Lives on the game instance so the preloaded handles
+ * survive the map change. The bundles stay empty until a CowGameData asset is authored under /Game/Data.
+ */
+UCLASS(config=Game)
+class MOOMOOMADNESS_API UCowAssetPreloadSubsystem : public UGameInstanceSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	/** Starts loading the Match bundle in the background, does nothing if it is already loading or loaded */
+	UFUNCTION(BlueprintCallable, Category = "Loading")
+	void PreloadMatchAssets();
+
+	/** Whether everything the Match bundle and MatchClasses point at is in memory */
+	UFUNCTION(BlueprintPure, Category = "Loading")
+	bool IsMatchPreloaded() const;
+
+protected:
+	//Map the Match bundle is preloaded from, every other map is treated as a match
+	UPROPERTY(config)
+	TSoftObjectPtr<UWorld> MenuMap;
+
+	//Classes preloaded with the Match bundle. Stands in for CowGameData's CowClass and DestroyableClasses while no asset exists
+	UPROPERTY(config)
+	TArray<TSoftClassPtr<AActor>> MatchClasses;
+
+private:
+	void OnPostLoadMap(UWorld* LoadedWorld);
+
+	TArray<FPrimaryAssetId> GetGameDataIds() const;
+
+	FDelegateHandle PostLoadMapHandle;
+
+	TSharedPtr<FStreamableHandle> MatchBundleHandle;
+	TSharedPtr<FStreamableHandle> MatchClassesHandle;
+
+	bool bMatchPreloadStarted = false;
+};
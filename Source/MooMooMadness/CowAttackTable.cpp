@@ -0,0 +1,61 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CowAttackTable.h"
+
+UCowAttackTable::UCowAttackTable()
+{
+	//New tables start with the values the attacks had when they were hard coded
+	FCowAttackDefinition& Headbutt = Attacks.AddDefaulted_GetRef();
+	Headbutt.Attack = ECowAttack::Headbutt;
+	Headbutt.LaunchSpeed = 1250.f;
+
+	FCowAttackDefinition& Charge = Attacks.AddDefaulted_GetRef();
+	Charge.Attack = ECowAttack::Charge;
+
+	FCowAttackDefinition& Kick = Attacks.AddDefaulted_GetRef();
+	Kick.Attack = ECowAttack::Kick;
+
+	Compile();
+}
+
+void UCowAttackTable::PostLoad()
+{
+	Super::PostLoad();
+
+	Compile();
+}
+
+#if WITH_EDITOR
+void UCowAttackTable::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+
+	Compile();
+}
+#endif
+
+void UCowAttackTable::Compile()
+{
+	for (FCowAttackKernel& Kernel : Kernels)
+	{
+		Kernel = FCowAttackKernel();
+	}
+
+	for (const FCowAttackDefinition& Definition : Attacks)
+	{
+		if (Definition.Attack == ECowAttack::None || Definition.Attack >= ECowAttack::MAX)
+		{
+			continue;
+		}
+
+		FCowAttackKernel& Kernel = Kernels[(uint8)Definition.Attack];
+		Kernel.Distance = Definition.Distance;
+		Kernel.Radius = Definition.Radius;
+		Kernel.LaunchSpeed = Definition.LaunchSpeed;
+		Kernel.LaunchDuration = Definition.LaunchDuration;
+		Kernel.InvincibleTime = Definition.InvincibleTime;
+		Kernel.HitScore = Definition.HitScore;
+		Kernel.VictimScore = Definition.VictimScore;
+	}
+}
@@ -0,0 +1,99 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "CowAttackTable.generated.h"
+
+UENUM(BlueprintType)
+enum class ECowAttack : uint8
+{
+	None,
+	Headbutt,
+	Charge,
+	Kick,
+
+	MAX UMETA(Hidden)
+};
+
+/** Everything the combat hot path needs to know about an attack, flattened out of FCowAttackDefinition */
+struct FCowAttackKernel
+{
+	float Distance = 50.f;
+	float Radius = 40.f;
+	float LaunchSpeed = 0.f;
+	float LaunchDuration = 0.25f;
+	float InvincibleTime = 1.5f;
+	int32 HitScore = 10;
+	int32 VictimScore = -10;
+};
+
+/** Designer facing tuning for one attack */
+USTRUCT(BlueprintType)
+struct FCowAttackDefinition
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Attack)
+	ECowAttack Attack = ECowAttack::None;
+
+	//How far ahead of the neck the attack sweeps
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Attack, meta = (ClampMin = "0"))
+	float Distance = 50.f;
+
+	//Radius of the swept sphere
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Attack, meta = (ClampMin = "1"))
+	float Radius = 40.f;
+
+	//Forward speed the attacker is launched at when the attack starts, 0 for none
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Attack, meta = (ClampMin = "0"))
+	float LaunchSpeed = 0.f;
+
+	//How long the launch speed is held, in seconds
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Attack, meta = (ClampMin = "0"))
+	float LaunchDuration = 0.25f;
+
+	//How long the attacker can't be hit after landing the attack on another cow
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Attack, meta = (ClampMin = "0"))
+	float InvincibleTime = 1.5f;
+
+	//Points the attacker gets for hitting another cow
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Score)
+	int32 HitScore = 10;
+
+	//Points the cow that got hit gets, usually negative
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Score)
+	int32 VictimScore = -10;
+};
+
+/**
+ * Tuning for every cow attack. Definitions are compiled on load into a flat array indexed by ECowAttack,
+ * so combat code never searches the definitions or reads properties by name.
+ */
+UCLASS(BlueprintType)
+class MOOMOOMADNESS_API UCowAttackTable : public UDataAsset
+{
+	GENERATED_BODY()
+
+public:
+	UCowAttackTable();
+
+	virtual void PostLoad() override;
+#if WITH_EDITOR
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
+
+	FORCEINLINE const FCowAttackKernel& GetKernel(ECowAttack Attack) const { return Kernels[(uint8)Attack]; }
+
+protected:
+	//Attacks missing from this list use the FCowAttackKernel defaults
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Attacks, meta = (TitleProperty = "Attack"))
+	TArray<FCowAttackDefinition> Attacks;
+
+private:
+	/** Rebuilds Kernels from Attacks */
+	void Compile();
+
+	TStaticArray<FCowAttackKernel, (uint8)ECowAttack::MAX> Kernels;
+};
@@ -0,0 +1,70 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CowBroadphaseSubsystem.h"
+
+#include "Components/SceneComponent.h"
+#include "GameFramework/Actor.h"
+
+UCowBroadphaseSubsystem::UCowBroadphaseSubsystem()
+	: SpatialHash(500.f)
+{
+}
+
+void UCowBroadphaseSubsystem::Register(AActor* Actor, ECowBroadphaseType Type, bool bMovable)
+{
+	if (!Actor || Handles.Contains(Actor))
+	{
+		return;
+	}
+
+	//Static actors use their full component bounds once, movable ones the cheaper cached root bounds every tick
+	const FBox Bounds = bMovable ? GetActorBounds(Actor) : Actor->GetComponentsBoundingBox(true);
+	const int32 Handle = SpatialHash.Add(Actor, Type, Bounds);
+	Handles.Add(Actor, Handle);
+	if (bMovable)
+	{
+		MovableEntries.Add({ Actor, Handle });
+	}
+}
+
+void UCowBroadphaseSubsystem::Unregister(AActor* Actor)
+{
+	int32 Handle;
+	if (!Handles.RemoveAndCopyValue(Actor, Handle))
+	{
+		return;
+	}
+
+	SpatialHash.Remove(Handle);
+	MovableEntries.RemoveAllSwap([Handle](const FMovableEntry& Entry) { return Entry.Handle == Handle; }, false);
+}
+
+void UCowBroadphaseSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	for (const FMovableEntry& Entry : MovableEntries)
+	{
+		if (const AActor* Actor = Entry.Actor.Get())
+		{
+			SpatialHash.Update(Entry.Handle, GetActorBounds(Actor));
+		}
+	}
+}
+
+TStatId UCowBroadphaseSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UCowBroadphaseSubsystem, STATGROUP_Tickables);
+}
+
+bool UCowBroadphaseSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+FBox UCowBroadphaseSubsystem::GetActorBounds(const AActor* Actor)
+{
+	const USceneComponent* Root = Actor->GetRootComponent();
+	return Root ? Root->Bounds.GetBox() : FBox(Actor->GetActorLocation(), Actor->GetActorLocation());
+}
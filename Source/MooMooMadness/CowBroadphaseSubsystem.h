@@ -0,0 +1,54 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "CowSpatialHash.h"
+#include "CowBroadphaseSubsystem.generated.h"
+
+/**
+ * Keeps every cow and destroyable in a spatial hash so combat and scoring code can find nearby candidates
+ * without a physics scene query. Static actors are hashed once, moving ones are refreshed every tick.
+ */
+UCLASS()
+class MOOMOOMADNESS_API UCowBroadphaseSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	UCowBroadphaseSubsystem();
+
+	/** Adds an actor to the hash. Movable actors have their bounds refreshed every tick */
+	void Register(AActor* Actor, ECowBroadphaseType Type, bool bMovable);
+
+	void Unregister(AActor* Actor);
+
+	/** Appends every registered actor matching TypeMask whose bounds overlap Box */
+	template<typename AllocatorType>
+	void Query(const FBox& Box, ECowBroadphaseType TypeMask, TArray<AActor*, AllocatorType>& OutActors) const
+	{
+		SpatialHash.Query(Box, TypeMask, OutActors);
+	}
+
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+	static FBox GetActorBounds(const AActor* Actor);
+
+	FCowSpatialHash SpatialHash;
+
+	//Hash handle of every registered actor
+	TMap<TObjectKey<AActor>, int32> Handles;
+
+	struct FMovableEntry
+	{
+		TWeakObjectPtr<AActor> Actor;
+		int32 Handle;
+	};
+	TArray<FMovableEntry> MovableEntries;
+};
@@ -0,0 +1,202 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CowCombatComponent.h"
+
+#include "MooMooMadnessCharacter.h"
+#include "CowLagCompensationComponent.h"
+#include "CowCombatSubsystem.h"
+#include "CowBroadphaseSubsystem.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "GameFramework/PlayerState.h"
+
+// Sets default values for this component's properties
+UCowCombatComponent::UCowCombatComponent()
+{
+	//Only ticks while an attack window is open
+	PrimaryComponentTick.bCanEverTick = true;
+	PrimaryComponentTick.bStartWithTickEnabled = false;
+	//Sweep after movement and animation so the neck bone is where it was rendered this frame
+	PrimaryComponentTick.TickGroup = TG_PostPhysics;
+}
+
+// Called when the game starts
+void UCowCombatComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	OwnerCow = Cast<AMooMooMadnessCharacter>(GetOwner());
+	CombatSubsystem = GetWorld()->GetSubsystem<UCowCombatSubsystem>();
+	Broadphase = GetWorld()->GetSubsystem<UCowBroadphaseSubsystem>();
+
+	//Resolve the bone once instead of looking it up by name on every sweep
+	if (OwnerCow && OwnerCow->GetMesh())
+	{
+		TraceBoneIndex = OwnerCow->GetMesh()->GetBoneIndex(TraceBoneName);
+	}
+
+	//Both tick in TG_PostPhysics, make the order explicit so this frame's snapshot is always recorded before a sweep
+	//is queued against it. Other cows' histories are only read once the subsystem ticks, after every component has
+	if (OwnerCow && OwnerCow->GetLagCompensationComponent())
+	{
+		AddTickPrerequisiteComponent(OwnerCow->GetLagCompensationComponent());
+	}
+}
+
+void UCowCombatComponent::BeginAttack(ECowAttack Attack)
+{
+	//Holding sprint keeps re-requesting the same attack, don't restart it
+	if (!OwnerCow || !CombatSubsystem || !Broadphase || Attack == ECowAttack::None || Attack == ActiveAttack)
+	{
+		return;
+	}
+
+	ActiveAttack = Attack;
+	ActiveKernel = OwnerCow->GetAttackKernel(Attack);
+
+	//Forget hits from older swings, each victim can be hit once per swing
+	++SwingId;
+	SwingHits.RemoveAllSwap([this](const FSwingHit& SwingHit) { return SwingHit.SwingId + 1 < SwingId; }, false);
+
+	bHasLastTrace = false;
+	SetComponentTickEnabled(true);
+}
+
+void UCowCombatComponent::EndAttack()
+{
+	ActiveAttack = ECowAttack::None;
+	bHasLastTrace = false;
+	SetComponentTickEnabled(false);
+}
+
+void UCowCombatComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	if (!OwnerCow || !OwnerCow->IsAttackWindowOpen(ActiveAttack))
+	{
+		EndAttack();
+		return;
+	}
+
+	const FVector Start = GetTraceStart();
+	const FVector Direction = OwnerCow->GetActorForwardVector();
+	RewindTime = GetRewindTime();
+
+	//Split the distance travelled since last frame into radius sized steps so fast charges can't skip over targets
+	int32 NumSteps = 1;
+	if (bHasLastTrace)
+	{
+		const float Travelled = FVector::Dist(LastTraceStart, Start);
+		NumSteps = FMath::Clamp(FMath::CeilToInt(Travelled / ActiveKernel.Radius), 1, MaxSubsteps);
+	}
+
+	for (int32 Step = 1; Step < NumSteps; ++Step)
+	{
+		const float Alpha = (float)Step / NumSteps;
+		QueueSweep(FMath::Lerp(LastTraceStart, Start, Alpha), FMath::Lerp(LastTraceDirection, Direction, Alpha).GetSafeNormal());
+	}
+	QueueSweep(Start, Direction);
+
+	LastTraceStart = Start;
+	LastTraceDirection = Direction;
+	bHasLastTrace = true;
+}
+
+FVector UCowCombatComponent::GetTraceStart() const
+{
+	const USkeletalMeshComponent* Mesh = OwnerCow->GetMesh();
+	const FVector BoneLocation = TraceBoneIndex != INDEX_NONE ? Mesh->GetBoneTransform(TraceBoneIndex).GetLocation() : Mesh->GetComponentLocation();
+	return BoneLocation + TraceOffset;
+}
+
+double UCowCombatComponent::GetRewindTime() const
+{
+	const double Now = GetWorld()->GetTimeSeconds();
+	const APlayerState* PlayerState = OwnerCow->GetPlayerState();
+	if (!bUseLagCompensation || !PlayerState)
+	{
+		return Now;
+	}
+	//The attack reaches us half a round trip after the attacker saw it, and what they saw was other cows' smoothed
+	//positions, which trail the last update they got by the simulated proxy smoothing time
+	const float OneWayLatency = PlayerState->GetPingInMilliseconds()*0.001f*0.5f;
+	const float InterpolationDelay = OwnerCow->GetCharacterMovement()->NetworkSimulatedSmoothLocationTime;
+	return Now - FMath::Min(OneWayLatency + InterpolationDelay, MaxRewindTime);
+}
+
+void UCowCombatComponent::QueueSweep(const FVector& Start, const FVector& Direction)
+{
+	const FVector End = Start + Direction*ActiveKernel.Distance;
+
+	//Only pay for a physics sweep when something it can hit is nearby, rewound cows don't need one
+	TArray<AActor*, TInlineAllocator<16>> Candidates;
+	const ECowBroadphaseType SceneTypes = bUseLagCompensation ? ECowBroadphaseType::Destroyable : ECowBroadphaseType::All;
+	Broadphase->Query(FBox(Start.ComponentMin(End), Start.ComponentMax(End)).ExpandBy(ActiveKernel.Radius), SceneTypes, Candidates);
+
+	FCowSweepRequest Request;
+	Request.Requester = this;
+	Request.Attack = ActiveAttack;
+	Request.SwingId = SwingId;
+	Request.Start = Start;
+	Request.End = End;
+	Request.Radius = ActiveKernel.Radius;
+	Request.RewindTime = RewindTime;
+	Request.bTraceScene = Candidates.Num() > 0;
+
+	//DrawDebugSphere(GetWorld(), Start, ActiveKernel.Radius, 12, FColor::Red, false, 3.f);
+	CombatSubsystem->QueueSweep(MoveTemp(Request));
+}
+
+void UCowCombatComponent::ResolveSweep(const FCowSweepRequest& Request, const TArray<FHitResult>& Hits)
+{
+	if (!OwnerCow) { return; }
+
+	for (const FHitResult& Hit : Hits)
+	{
+		//Cows are checked against their rewound history below
+		if (bUseLagCompensation && Cast<AMooMooMadnessCharacter>(Hit.GetActor()))
+		{
+			continue;
+		}
+		ApplySwingHit(Hit, Request);
+	}
+
+	if (!bUseLagCompensation)
+	{
+		return;
+	}
+
+	TArray<AActor*, TInlineAllocator<16>> Cows;
+	Broadphase->Query(FBox(Request.Start.ComponentMin(Request.End), Request.Start.ComponentMax(Request.End)).ExpandBy(Request.Radius + RewindQueryMargin), ECowBroadphaseType::Cow, Cows);
+	for (AActor* Actor : Cows)
+	{
+		AMooMooMadnessCharacter* Cow = CastChecked<AMooMooMadnessCharacter>(Actor);
+		FHitResult RewoundHit;
+		if (Cow != OwnerCow && Cow->GetLagCompensationComponent()->SweepRewound(Request.RewindTime, Request.Start, Request.End, Request.Radius, RewoundHit))
+		{
+			ApplySwingHit(RewoundHit, Request);
+		}
+	}
+}
+
+void UCowCombatComponent::ApplySwingHit(const FHitResult& Hit, const FCowSweepRequest& Request)
+{
+	//Anything past the cap goes unhit this swing rather than spilling the list to the heap
+	const AActor* HitActor = Hit.GetActor();
+	if (!HitActor || SwingHits.Num() >= MaxSwingHits) { return; }
+
+	//Every instance of a field is its own target, one swing can flatten a whole row of bales
+	const int32 HitItem = Cast<UInstancedStaticMeshComponent>(Hit.GetComponent()) ? Hit.Item : INDEX_NONE;
+	const bool bAlreadyHit = SwingHits.ContainsByPredicate([HitActor, HitItem, &Request](const FSwingHit& SwingHit)
+	{
+		return SwingHit.SwingId == Request.SwingId && SwingHit.Actor == HitActor && SwingHit.Item == HitItem;
+	});
+
+	//Only remember hits that did something, an invincible cow can still be hit later in the swing
+	if (!bAlreadyHit && OwnerCow->ApplyCombatHit(Hit, Request.Attack))
+	{
+		SwingHits.Add({ HitActor, HitItem, Request.SwingId });
+	}
+}
@@ -0,0 +1,121 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "CowAttackTable.h"
+#include "CowCombatComponent.generated.h"
+
+class AMooMooMadnessCharacter;
+class UCowCombatSubsystem;
+class UCowBroadphaseSubsystem;
+struct FCowSweepRequest;
+
+/**
+ * Server-side hit detection for cow attacks.
+ * Only ticks while an attack window is open, queuing a sphere sweep from the neck bone every frame
+ * and substepping the sweep when the cow has moved further than the sphere radius since the last one.
+ * Sweeps run asynchronously through UCowCombatSubsystem and their hits are applied a frame later.
+ */
+UCLASS(ClassGroup=(Combat), meta=(BlueprintSpawnableComponent))
+class MOOMOOMADNESS_API UCowCombatComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	// Sets default values for this component's properties
+	UCowCombatComponent();
+
+	/** Opens an attack window, sweeping with the owner's tuning for Attack until EndAttack is called */
+	void BeginAttack(ECowAttack Attack);
+
+	/** Closes the current attack window and stops ticking */
+	void EndAttack();
+
+	FORCEINLINE ECowAttack GetActiveAttack() const { return ActiveAttack; }
+	FORCEINLINE bool IsAttackActive() const { return ActiveAttack != ECowAttack::None; }
+
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+	/** Applies the hits of a finished sweep, called by UCowCombatSubsystem */
+	void ResolveSweep(const FCowSweepRequest& Request, const TArray<FHitResult>& Hits);
+
+protected:
+	// Called when the game starts
+	virtual void BeginPlay() override;
+
+	//Bone the attack sweep starts from
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Combat)
+	FName TraceBoneName = "Neck3";
+
+	//Offset applied to the bone location before sweeping
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Combat)
+	FVector TraceOffset = FVector(0.f, 0.f, -20.f);
+
+	//Upper bound on sweeps per tick when the cow moves faster than one radius per frame
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Combat, meta = (ClampMin = "1"))
+	int32 MaxSubsteps = 4;
+
+	//Check other cows where the attacker saw them instead of where the server has them now
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Combat)
+	bool bUseLagCompensation = true;
+
+	//Never rewind further than this, in seconds, so very high pings can't hit from far away
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Combat, meta = (EditCondition = "bUseLagCompensation"))
+	float MaxRewindTime = 0.25f;
+
+	//How far a rewound cow may be from where the broadphase has it now
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Combat, meta = (EditCondition = "bUseLagCompensation"))
+	float RewindQueryMargin = 400.f;
+
+private:
+	FVector GetTraceStart() const;
+
+	/** Server time the attacker's view of the world corresponds to, half their ping plus the proxy smoothing delay */
+	double GetRewindTime() const;
+
+	void QueueSweep(const FVector& Start, const FVector& Direction);
+
+	/** Applies a hit unless the actor was already hit during the same swing */
+	void ApplySwingHit(const FHitResult& Hit, const FCowSweepRequest& Request);
+
+	UPROPERTY()
+	AMooMooMadnessCharacter* OwnerCow;
+
+	UPROPERTY()
+	UCowCombatSubsystem* CombatSubsystem;
+
+	UPROPERTY()
+	UCowBroadphaseSubsystem* Broadphase;
+
+	int32 TraceBoneIndex = INDEX_NONE;
+
+	ECowAttack ActiveAttack = ECowAttack::None;
+	FCowAttackKernel ActiveKernel;
+
+	//Incremented every time an attack window opens
+	uint32 SwingId = 0;
+
+	struct FSwingHit
+	{
+		TWeakObjectPtr<const AActor> Actor;
+		//Instance index for instanced fields, INDEX_NONE otherwise
+		int32 Item;
+		uint32 SwingId;
+	};
+	//A charge through an instanced field hits dozens of instances, this covers that for the current and previous swing
+	static constexpr int32 MaxSwingHits = 64;
+
+	//Actors already hit by the current and previous swing, the previous one can still have sweeps in flight.
+	//Never grows past MaxSwingHits so it stays in the inline storage
+	TArray<FSwingHit, TInlineAllocator<MaxSwingHits>> SwingHits;
+
+	//Time other cows are rewound to for this tick's sweeps
+	double RewindTime = 0.0;
+
+	//Where the previous tick's sweep started, used to fill the gap between frames
+	FVector LastTraceStart = FVector::ZeroVector;
+	FVector LastTraceDirection = FVector::ForwardVector;
+	bool bHasLastTrace = false;
+};
@@ -0,0 +1,77 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CowCombatSubsystem.h"
+
+#include "Engine/World.h"
+
+void UCowCombatSubsystem::QueueSweep(FCowSweepRequest&& Request)
+{
+	PendingSweeps.Add(MoveTemp(Request));
+}
+
+void UCowCombatSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	UWorld* World = GetWorld();
+	if (!World) { return; }
+
+	//Hand back last frame's results before submitting this frame's sweeps
+	ResolveSweeps(World);
+	SubmitSweeps(World);
+}
+
+TStatId UCowCombatSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UCowCombatSubsystem, STATGROUP_Tickables);
+}
+
+bool UCowCombatSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UCowCombatSubsystem::ResolveSweeps(UWorld* World)
+{
+	int32 NumStillInFlight = 0;
+	for (FCowSweepRequest& Request : InFlightSweeps)
+	{
+		FTraceDatum Result;
+		if (Request.bTraceScene && !World->QueryTraceData(Request.Handle, Result))
+		{
+			//Not finished yet, keep it around unless the handle expired
+			if (World->IsTraceHandleValid(Request.Handle, false))
+			{
+				InFlightSweeps[NumStillInFlight++] = MoveTemp(Request);
+			}
+			continue;
+		}
+
+		if (UCowCombatComponent* Requester = Request.Requester.Get())
+		{
+			Requester->ResolveSweep(Request, Result.OutHits);
+		}
+	}
+	InFlightSweeps.SetNum(NumStillInFlight, false);
+}
+
+void UCowCombatSubsystem::SubmitSweeps(UWorld* World)
+{
+	for (FCowSweepRequest& Request : PendingSweeps)
+	{
+		const UCowCombatComponent* Requester = Request.Requester.Get();
+		if (!Requester) { continue; }
+
+		if (!Request.bTraceScene)
+		{
+			InFlightSweeps.Add(MoveTemp(Request));
+			continue;
+		}
+
+		FCollisionQueryParams CollisionParams(SCENE_QUERY_STAT(CowCombatSweep), false, Requester->GetOwner());
+		Request.Handle = World->AsyncSweepByChannel(EAsyncTraceType::Multi, Request.Start, Request.End, FQuat::Identity, ECC_Visibility, FCollisionShape::MakeSphere(Request.Radius), CollisionParams);
+		InFlightSweeps.Add(MoveTemp(Request));
+	}
+	PendingSweeps.Reset();
+}
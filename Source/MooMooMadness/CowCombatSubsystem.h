@@ -0,0 +1,56 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "CowCombatComponent.h"
+#include "CowCombatSubsystem.generated.h"
+
+/** One combat sweep waiting for its async result */
+struct FCowSweepRequest
+{
+	TWeakObjectPtr<UCowCombatComponent> Requester;
+	ECowAttack Attack = ECowAttack::None;
+	//Which swing of the requester this sweep belongs to
+	uint32 SwingId = 0;
+	FVector Start = FVector::ZeroVector;
+	FVector End = FVector::ZeroVector;
+	float Radius = 0.f;
+	//Time other cows are rewound to when the result is resolved
+	double RewindTime = 0.0;
+	//False when the broadphase found nothing the physics scene could add, the request then resolves with no hits
+	bool bTraceScene = true;
+	FTraceHandle Handle;
+};
+
+/**
+ * Collects every combat sweep queued during a frame and submits them together through the async trace API.
+ * Results are handed back to the requesting components when this subsystem ticks on the following frame,
+ * so the game thread never waits on a synchronous sweep.
+ */
+UCLASS()
+class MOOMOOMADNESS_API UCowCombatSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/** Queues a sphere sweep on ECC_Visibility ignoring the requester's owner, resolved next frame */
+	void QueueSweep(FCowSweepRequest&& Request);
+
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+	void ResolveSweeps(UWorld* World);
+	void SubmitSweeps(UWorld* World);
+
+	//Queued this frame, submitted when the subsystem ticks
+	TArray<FCowSweepRequest> PendingSweeps;
+
+	//Submitted last frame, resolved when the subsystem ticks
+	TArray<FCowSweepRequest> InFlightSweeps;
+};
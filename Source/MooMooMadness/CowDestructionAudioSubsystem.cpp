@@ -0,0 +1,212 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CowDestructionAudioSubsystem.h"
+
+#include "Components/AudioComponent.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "Sound/SoundBase.h"
+
+bool UCowDestructionAudioSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	return !IsRunningDedicatedServer() && FApp::CanEverRenderAudio() && Super::ShouldCreateSubsystem(Outer);
+}
+
+bool UCowDestructionAudioSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UCowDestructionAudioSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	//PIE dedicated servers share the process with clients that can render audio
+	if (InWorld.GetNetMode() == NM_DedicatedServer)
+	{
+		return;
+	}
+
+	//Props load their sounds after this, so rules are matched by path rather than by loaded object
+	for (int32 RuleIndex = 0; RuleIndex < SoundRules.Num(); RuleIndex++)
+	{
+		const FSoftObjectPath& SoundPath = SoundRules[RuleIndex].Sound.ToSoftObjectPath();
+		if (!SoundPath.IsNull())
+		{
+			RuleIndices.Add(SoundPath, RuleIndex);
+		}
+	}
+
+	PooledComponents.Reserve(PoolSize);
+	Voices.Reserve(PoolSize);
+	for (int32 Index = 0; Index < PoolSize; Index++)
+	{
+		UAudioComponent* Component = NewObject<UAudioComponent>(&InWorld);
+		Component->bAutoActivate = false;
+		Component->bAutoDestroy = false;
+		Component->bAllowSpatialization = true;
+		Component->bIsUISound = false;
+		Component->RegisterComponentWithWorld(&InWorld);
+		PooledComponents.Add(Component);
+		Voices.Add({ Component, nullptr, 0.0, FVector::ZeroVector });
+	}
+}
+
+void UCowDestructionAudioSubsystem::Deinitialize()
+{
+	//The pool is registered with the world but owned by nothing in it, so nothing else tears it down
+	for (UAudioComponent* Component : PooledComponents)
+	{
+		if (Component)
+		{
+			Component->Stop();
+			Component->DestroyComponent();
+		}
+	}
+	PooledComponents.Reset();
+	Voices.Reset();
+	PendingBatches.Reset();
+
+	Super::Deinitialize();
+}
+
+TStatId UCowDestructionAudioSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UCowDestructionAudioSubsystem, STATGROUP_Tickables);
+}
+
+void UCowDestructionAudioSubsystem::QueueDestruction(USoundBase* Sound, const FVector& Location, float Priority)
+{
+	if (!Sound || Voices.IsEmpty())
+	{
+		return;
+	}
+
+	//Hits at opposite ends of the map are heard in two places, not once in the middle
+	const double BatchRadiusSquared = FMath::Square(BatchRadius);
+	FBatch* Batch = PendingBatches.FindByPredicate([Sound, &Location, BatchRadiusSquared](const FBatch& Pending)
+	{
+		return Pending.Sound == Sound && FVector::DistSquared(Pending.LocationSum/Pending.HitCount, Location) <= BatchRadiusSquared;
+	});
+	if (!Batch)
+	{
+		Batch = &PendingBatches.AddDefaulted_GetRef();
+		Batch->Sound = Sound;
+	}
+	Batch->LocationSum += Location;
+	Batch->HitCount++;
+	Batch->Priority = FMath::Max(Batch->Priority, Priority);
+}
+
+void UCowDestructionAudioSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	if (PendingBatches.IsEmpty())
+	{
+		return;
+	}
+
+	FVector ListenerLocation = FVector::ZeroVector;
+	if (const APlayerController* PlayerController = GetWorld()->GetFirstPlayerController())
+	{
+		FVector Front, Right;
+		PlayerController->GetAudioListenerPosition(ListenerLocation, Front, Right);
+	}
+
+	for (const FBatch& Batch : PendingBatches)
+	{
+		PlayBatch(Batch, ListenerLocation);
+	}
+	PendingBatches.Reset();
+}
+
+const FCowDestructionSoundRule& UCowDestructionAudioSubsystem::GetRule(const USoundBase* Sound) const
+{
+	const int32* RuleIndex = RuleIndices.Find(FSoftObjectPath(Sound));
+	return RuleIndex ? SoundRules[*RuleIndex] : DefaultRule;
+}
+
+int32 UCowDestructionAudioSubsystem::AcquireVoice(const USoundBase* Sound, const FVector& Location, const FVector& ListenerLocation) const
+{
+	const FCowDestructionSoundRule& Rule = GetRule(Sound);
+
+	int32 FreeVoice = INDEX_NONE;
+	int32 OldestVoice = INDEX_NONE;
+	int32 SameSoundVoices = 0;
+	int32 OldestSameSound = INDEX_NONE;
+	int32 FarthestSameSound = INDEX_NONE;
+	double FarthestDistSquared = -1.0;
+
+	for (int32 Index = 0; Index < Voices.Num(); Index++)
+	{
+		const FVoice& Voice = Voices[Index];
+		if (!Voice.Component->IsPlaying())
+		{
+			FreeVoice = FreeVoice == INDEX_NONE ? Index : FreeVoice;
+			continue;
+		}
+
+		if (OldestVoice == INDEX_NONE || Voice.StartTime < Voices[OldestVoice].StartTime)
+		{
+			OldestVoice = Index;
+		}
+
+		if (Voice.Sound == Sound)
+		{
+			SameSoundVoices++;
+			if (OldestSameSound == INDEX_NONE || Voice.StartTime < Voices[OldestSameSound].StartTime)
+			{
+				OldestSameSound = Index;
+			}
+			const double DistSquared = FVector::DistSquared(Voice.Location, ListenerLocation);
+			if (DistSquared > FarthestDistSquared)
+			{
+				FarthestDistSquared = DistSquared;
+				FarthestSameSound = Index;
+			}
+		}
+	}
+
+	if (SameSoundVoices >= FMath::Max(Rule.MaxVoices, 1))
+	{
+		switch (Rule.Stealing)
+		{
+		case ECowVoiceStealing::StopOldest:
+			return OldestSameSound;
+		case ECowVoiceStealing::StopFarthest:
+			return FVector::DistSquared(Location, ListenerLocation) < FarthestDistSquared ? FarthestSameSound : INDEX_NONE;
+		default:
+			return INDEX_NONE;
+		}
+	}
+
+	//Under its own limit but the pool is full, the oldest voice of any sound makes way
+	return FreeVoice != INDEX_NONE ? FreeVoice : OldestVoice;
+}
+
+void UCowDestructionAudioSubsystem::PlayBatch(const FBatch& Batch, const FVector& ListenerLocation)
+{
+	const FVector Location = Batch.LocationSum/Batch.HitCount;
+	const int32 VoiceIndex = AcquireVoice(Batch.Sound, Location, ListenerLocation);
+	if (VoiceIndex == INDEX_NONE)
+	{
+		return;
+	}
+
+	FVoice& Voice = Voices[VoiceIndex];
+	UAudioComponent* Component = Voice.Component;
+	Component->Stop();
+	Component->SetSound(Batch.Sound);
+	Component->SetWorldLocation(Location);
+	Component->SetIntParameter(HitCountParameter, Batch.HitCount);
+	Component->SetVolumeMultiplier(1.f + VolumePerDoubling*FMath::Log2((float)Batch.HitCount));
+	Component->bOverridePriority = true;
+	Component->Priority = Batch.Priority;
+	Component->Play();
+
+	Voice.Sound = Batch.Sound;
+	Voice.StartTime = GetWorld()->GetTimeSeconds();
+	Voice.Location = Location;
+}
@@ -0,0 +1,122 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "CowDestructionAudioSubsystem.generated.h"
+
+class UAudioComponent;
+class USoundBase;
+
+/** What happens when a sound already has its maximum number of voices playing */
+UENUM()
+enum class ECowVoiceStealing : uint8
+{
+	//Cut the voice that started first
+	StopOldest,
+	//Cut the voice furthest from the listener, or drop the new one if it is further still
+	StopFarthest,
+	//Keep what is playing and drop the new one
+	RejectNew
+};
+
+/** Concurrency rule for one destruction sound */
+USTRUCT()
+struct FCowDestructionSoundRule
+{
+	GENERATED_BODY()
+
+	UPROPERTY(config)
+	TSoftObjectPtr<USoundBase> Sound;
+
+	UPROPERTY(config)
+	int32 MaxVoices = 3;
+
+	UPROPERTY(config)
+	ECowVoiceStealing Stealing = ECowVoiceStealing::StopOldest;
+};
+
+/**
+ * Plays destruction sounds through a fixed pool of audio components allocated when the world begins play.
+ * Destructions of the same sound queued during a frame within BatchRadius of each other are batched into one voice
+ * at their centroid, which gets the number of hits in its HitCountParameter so the cue can layer itself, and each
+ * sound is held to a voice limit with a stealing rule. Not created on dedicated servers.
+ */
+UCLASS(config=Game)
+class MOOMOOMADNESS_API UCowDestructionAudioSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	/** Queues a destruction sound, played with the rest of this frame's destructions at the highest priority among them */
+	void QueueDestruction(USoundBase* Sound, const FVector& Location, float Priority = 1.f);
+
+protected:
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	//Audio components allocated up front, nothing is spawned after begin play
+	UPROPERTY(config)
+	int32 PoolSize = 16;
+
+	//Used for sounds without a rule of their own
+	UPROPERTY(config)
+	FCowDestructionSoundRule DefaultRule;
+
+	UPROPERTY(config)
+	TArray<FCowDestructionSoundRule> SoundRules;
+
+	//Same sound destructions closer than this to a batch's centroid join it, further ones get a voice of their own
+	UPROPERTY(config, meta = (ForceUnits = "cm"))
+	float BatchRadius = 1500.f;
+
+	//Int parameter set to the number of destructions a voice stands for
+	UPROPERTY(config)
+	FName HitCountParameter = "HitCount";
+
+	//Extra volume per doubling of the hit count, for cues that don't read the parameter
+	UPROPERTY(config)
+	float VolumePerDoubling = 0.15f;
+
+private:
+	struct FVoice
+	{
+		//Kept alive by PooledComponents
+		UAudioComponent* Component = nullptr;
+		TWeakObjectPtr<USoundBase> Sound;
+		double StartTime = 0.0;
+		FVector Location = FVector::ZeroVector;
+	};
+
+	struct FBatch
+	{
+		USoundBase* Sound = nullptr;
+		FVector LocationSum = FVector::ZeroVector;
+		int32 HitCount = 0;
+		float Priority = 0.f;
+	};
+
+	const FCowDestructionSoundRule& GetRule(const USoundBase* Sound) const;
+
+	/** Picks the voice to play a batch on, stealing one if the rules allow, INDEX_NONE to drop the batch */
+	int32 AcquireVoice(const USoundBase* Sound, const FVector& Location, const FVector& ListenerLocation) const;
+
+	void PlayBatch(const FBatch& Batch, const FVector& ListenerLocation);
+
+	UPROPERTY(Transient)
+	TArray<TObjectPtr<UAudioComponent>> PooledComponents;
+
+	TArray<FVoice> Voices;
+
+	//This frame's destructions, one entry per sound and area
+	TArray<FBatch, TInlineAllocator<4>> PendingBatches;
+
+	//Rules by sound path, so rules for sounds that load after begin play still match
+	TMap<FSoftObjectPath, int32> RuleIndices;
+};
@@ -0,0 +1,11 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CowGameData.h"
+
+const FPrimaryAssetType UCowGameData::PrimaryAssetType = TEXT("CowGameData");
+
+FPrimaryAssetId UCowGameData::GetPrimaryAssetId() const
+{
+	return FPrimaryAssetId(PrimaryAssetType, GetFName());
+}
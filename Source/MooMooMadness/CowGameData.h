@@ -0,0 +1,41 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "CowGameData.generated.h"
+
+class ADestroyable;
+class AMooMooMadnessCharacter;
+
+/**
+ * Primary asset listing what the menu and a match need, split into the "Menu" and "Match" asset bundles.
+ * Everything is soft referenced, so loading this costs nothing until UCowAssetPreloadSubsystem asks for a bundle.
+ */
+UCLASS(BlueprintType)
+class MOOMOOMADNESS_API UCowGameData : public UPrimaryDataAsset
+{
+	GENERATED_BODY()
+
+public:
+	static const FPrimaryAssetType PrimaryAssetType;
+
+	virtual FPrimaryAssetId GetPrimaryAssetId() const override;
+
+	//Widgets, textures and sounds the main menu shows
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Menu", meta = (AssetBundles = "Menu"))
+	TArray<TSoftObjectPtr<UObject>> MenuAssets;
+
+	//The cow players spawn as, the input and montages it references load with it
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Match", meta = (AssetBundles = "Match"))
+	TSoftClassPtr<AMooMooMadnessCharacter> CowClass;
+
+	//Destroyable classes placed in match maps, their meshes and sounds load with them
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Match", meta = (AssetBundles = "Match"))
+	TArray<TSoftClassPtr<ADestroyable>> DestroyableClasses;
+
+	//Anything else a match needs up front
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Match", meta = (AssetBundles = "Match"))
+	TArray<TSoftObjectPtr<UObject>> MatchAssets;
+};
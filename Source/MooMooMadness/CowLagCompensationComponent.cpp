@@ -0,0 +1,132 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CowLagCompensationComponent.h"
+
+#include "MooMooMadnessCharacter.h"
+#include "Components/CapsuleComponent.h"
+#include "Components/SkeletalMeshComponent.h"
+
+// Sets default values for this component's properties
+UCowLagCompensationComponent::UCowLagCompensationComponent()
+{
+	//Tick is only enabled on the server, see BeginPlay
+	PrimaryComponentTick.bCanEverTick = true;
+	PrimaryComponentTick.bStartWithTickEnabled = false;
+	PrimaryComponentTick.TickGroup = TG_PostPhysics;
+}
+
+// Called when the game starts
+void UCowLagCompensationComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	OwnerCow = Cast<AMooMooMadnessCharacter>(GetOwner());
+	if (!OwnerCow || !OwnerCow->HasAuthority())
+	{
+		return;
+	}
+
+	if (OwnerCow->GetMesh())
+	{
+		NeckBoneIndex = OwnerCow->GetMesh()->GetBoneIndex(NeckBoneName);
+	}
+	SetComponentTickEnabled(true);
+}
+
+void UCowLagCompensationComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	RecordSnapshot();
+}
+
+void UCowLagCompensationComponent::RecordSnapshot()
+{
+	if (!OwnerCow) { return; }
+
+	HistoryHead = (HistoryHead + 1) % HistorySize;
+	HistoryNum = FMath::Min(HistoryNum + 1, HistorySize);
+
+	FCowHitboxSnapshot& Snapshot = History[HistoryHead];
+	const UCapsuleComponent* Capsule = OwnerCow->GetCapsuleComponent();
+	const USkeletalMeshComponent* Mesh = OwnerCow->GetMesh();
+	Snapshot.Time = GetWorld()->GetTimeSeconds();
+	Snapshot.CapsuleLocation = Capsule->GetComponentLocation();
+	Snapshot.CapsuleRotation = Capsule->GetComponentQuat();
+	Snapshot.NeckLocation = NeckBoneIndex != INDEX_NONE ? Mesh->GetBoneTransform(NeckBoneIndex).GetLocation() : Mesh->GetComponentLocation();
+}
+
+bool UCowLagCompensationComponent::GetSnapshotAtTime(double Time, FCowHitboxSnapshot& OutSnapshot) const
+{
+	if (HistoryNum == 0)
+	{
+		return false;
+	}
+
+	//Walk back from the newest snapshot until we find the pair surrounding Time
+	const FCowHitboxSnapshot* Newer = &History[HistoryHead];
+	if (Time >= Newer->Time)
+	{
+		OutSnapshot = *Newer;
+		return true;
+	}
+
+	for (int32 Age = 1; Age < HistoryNum; ++Age)
+	{
+		const FCowHitboxSnapshot* Older = &History[(HistoryHead - Age + HistorySize) % HistorySize];
+		if (Time >= Older->Time)
+		{
+			const double Span = Newer->Time - Older->Time;
+			const float Alpha = Span > UE_SMALL_NUMBER ? (float)((Time - Older->Time) / Span) : 1.f;
+			OutSnapshot.Time = Time;
+			OutSnapshot.CapsuleLocation = FMath::Lerp(Older->CapsuleLocation, Newer->CapsuleLocation, Alpha);
+			OutSnapshot.CapsuleRotation = FQuat::Slerp(Older->CapsuleRotation, Newer->CapsuleRotation, Alpha);
+			OutSnapshot.NeckLocation = FMath::Lerp(Older->NeckLocation, Newer->NeckLocation, Alpha);
+			return true;
+		}
+		Newer = Older;
+	}
+
+	//Older than anything we kept, use the oldest snapshot
+	OutSnapshot = *Newer;
+	return true;
+}
+
+bool UCowLagCompensationComponent::SweepRewound(double Time, const FVector& Start, const FVector& End, float Radius, FHitResult& OutHit) const
+{
+	FCowHitboxSnapshot Snapshot;
+	if (!OwnerCow || !GetSnapshotAtTime(Time, Snapshot))
+	{
+		return false;
+	}
+
+	const UCapsuleComponent* Capsule = OwnerCow->GetCapsuleComponent();
+	const float CapsuleRadius = Capsule->GetScaledCapsuleRadius();
+	const FVector CapsuleAxis = Snapshot.CapsuleRotation.GetUpVector() * (Capsule->GetScaledCapsuleHalfHeight() - CapsuleRadius);
+
+	//Closest points between the sweep path and the capsule's inner segment
+	FVector SweepPoint, CapsulePoint;
+	FMath::SegmentDistToSegmentSafe(Start, End, Snapshot.CapsuleLocation - CapsuleAxis, Snapshot.CapsuleLocation + CapsuleAxis, SweepPoint, CapsulePoint);
+	float HitRadius = CapsuleRadius;
+
+	//The head pokes out of the capsule, check it separately
+	const FVector NeckPoint = FMath::ClosestPointOnSegment(Snapshot.NeckLocation, Start, End);
+	if (FVector::DistSquared(NeckPoint, Snapshot.NeckLocation) - FMath::Square(NeckRadius) < FVector::DistSquared(SweepPoint, CapsulePoint) - FMath::Square(CapsuleRadius))
+	{
+		SweepPoint = NeckPoint;
+		CapsulePoint = Snapshot.NeckLocation;
+		HitRadius = NeckRadius;
+	}
+
+	if (FVector::DistSquared(SweepPoint, CapsulePoint) > FMath::Square(Radius + HitRadius))
+	{
+		return false;
+	}
+
+	const FVector Normal = (SweepPoint - CapsulePoint).GetSafeNormal();
+	OutHit = FHitResult(OwnerCow, const_cast<UCapsuleComponent*>(Capsule), CapsulePoint + Normal*HitRadius, Normal);
+	OutHit.TraceStart = Start;
+	OutHit.TraceEnd = End;
+	return true;
+}
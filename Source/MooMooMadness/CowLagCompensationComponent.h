@@ -0,0 +1,67 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "CowLagCompensationComponent.generated.h"
+
+class AMooMooMadnessCharacter;
+
+/** Where a cow's hit volumes were at a given server time */
+struct FCowHitboxSnapshot
+{
+	double Time = 0.0;
+	FVector CapsuleLocation = FVector::ZeroVector;
+	FQuat CapsuleRotation = FQuat::Identity;
+	FVector NeckLocation = FVector::ZeroVector;
+};
+
+/**
+ * Server-side history of a cow's capsule and neck bone, recorded every tick into a fixed size ring buffer.
+ * Attackers rewind their victims by their own ping so hits land where the attacker actually saw them.
+ */
+UCLASS(ClassGroup=(Combat), meta=(BlueprintSpawnableComponent))
+class MOOMOOMADNESS_API UCowLagCompensationComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	//Number of snapshots kept, about a second of history at 60Hz
+	static constexpr int32 HistorySize = 64;
+
+	// Sets default values for this component's properties
+	UCowLagCompensationComponent();
+
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+	/** Interpolates the recorded hit volumes at Time, clamped to the oldest and newest snapshot. Returns false if nothing has been recorded yet */
+	bool GetSnapshotAtTime(double Time, FCowHitboxSnapshot& OutSnapshot) const;
+
+	/** Tests a swept sphere against the hit volumes rewound to Time */
+	bool SweepRewound(double Time, const FVector& Start, const FVector& End, float Radius, FHitResult& OutHit) const;
+
+protected:
+	// Called when the game starts
+	virtual void BeginPlay() override;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Combat)
+	FName NeckBoneName = "Neck3";
+
+	//Radius of the head hit volume around the neck bone, the capsule doesn't cover the head
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Combat)
+	float NeckRadius = 30.f;
+
+private:
+	void RecordSnapshot();
+
+	UPROPERTY()
+	AMooMooMadnessCharacter* OwnerCow;
+
+	int32 NeckBoneIndex = INDEX_NONE;
+
+	TStaticArray<FCowHitboxSnapshot, HistorySize> History;
+	//Index of the newest snapshot
+	int32 HistoryHead = INDEX_NONE;
+	int32 HistoryNum = 0;
+};
@@ -0,0 +1,98 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CowLeaderboardComponent.h"
+
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "GameFramework/GameStateBase.h"
+#include "Net/UnrealNetwork.h"
+
+void FCowLeaderboard::PostReplicatedReceive(const FFastArraySerializer::FPostReplicatedReceiveParameters& Parameters)
+{
+	if (Owner)
+	{
+		Owner->OnLeaderboardReplicated();
+	}
+}
+
+UCowLeaderboardComponent::UCowLeaderboardComponent()
+{
+	PrimaryComponentTick.bCanEverTick = false;
+	bWantsInitializeComponent = true;
+	SetIsReplicatedByDefault(true);
+}
+
+UCowLeaderboardComponent* UCowLeaderboardComponent::GetLeaderboard(const UObject* WorldContextObject)
+{
+	const UWorld* World = GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::LogAndReturnNull);
+	const AGameStateBase* GameState = World ? World->GetGameState() : nullptr;
+	return GameState ? GameState->FindComponentByClass<UCowLeaderboardComponent>() : nullptr;
+}
+
+void UCowLeaderboardComponent::InitializeComponent()
+{
+	Super::InitializeComponent();
+
+	Leaderboard.Owner = this;
+}
+
+void UCowLeaderboardComponent::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME(UCowLeaderboardComponent, Leaderboard);
+}
+
+void UCowLeaderboardComponent::AddEntry(int32 PlayerId, int32 Score)
+{
+	if (Leaderboard.Items.ContainsByPredicate([PlayerId](const FCowLeaderboardEntry& Entry) { return Entry.PlayerId == PlayerId; }))
+	{
+		return;
+	}
+
+	FCowLeaderboardEntry& Entry = Leaderboard.Items.AddDefaulted_GetRef();
+	Entry.PlayerId = PlayerId;
+	Entry.Score = Score;
+	Leaderboard.MarkItemDirty(Entry);
+	RebuildRankings();
+}
+
+void UCowLeaderboardComponent::RemoveEntry(int32 PlayerId)
+{
+	const int32 Index = Leaderboard.Items.IndexOfByPredicate([PlayerId](const FCowLeaderboardEntry& Entry) { return Entry.PlayerId == PlayerId; });
+	if (Index == INDEX_NONE) { return; }
+
+	Leaderboard.Items.RemoveAtSwap(Index);
+	Leaderboard.MarkArrayDirty();
+	RebuildRankings();
+}
+
+void UCowLeaderboardComponent::UpdateEntry(int32 PlayerId, int32 Score, int32 Delta)
+{
+	FCowLeaderboardEntry* Entry = Leaderboard.Items.FindByPredicate([PlayerId](const FCowLeaderboardEntry& Entry) { return Entry.PlayerId == PlayerId; });
+	if (!Entry) { return; }
+
+	Entry->Score = Score;
+	//Losing points breaks the streak, the slow score decay included
+	Entry->Streak = Delta > 0 ? (uint8)FMath::Min<int32>(Entry->Streak + 1, MAX_uint8) : 0;
+	Leaderboard.MarkItemDirty(*Entry);
+	RebuildRankings();
+}
+
+void UCowLeaderboardComponent::OnLeaderboardReplicated()
+{
+	RebuildRankings();
+}
+
+void UCowLeaderboardComponent::RebuildRankings()
+{
+	Rankings = Leaderboard.Items;
+	//Ties keep the player who joined first on top
+	Rankings.Sort([](const FCowLeaderboardEntry& A, const FCowLeaderboardEntry& B)
+	{
+		return A.Score != B.Score ? A.Score > B.Score : A.PlayerId < B.PlayerId;
+	});
+
+	OnLeaderboardChanged.Broadcast();
+}
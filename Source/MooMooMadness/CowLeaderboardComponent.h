@@ -0,0 +1,111 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "Net/Serialization/FastArraySerializer.h"
+#include "CowLeaderboardComponent.generated.h"
+
+class UCowLeaderboardComponent;
+
+/** One player's row on the leaderboard */
+USTRUCT(BlueprintType)
+struct FCowLeaderboardEntry : public FFastArraySerializerItem
+{
+	GENERATED_BODY()
+
+	//APlayerState::GetPlayerId of the player this row belongs to
+	UPROPERTY(BlueprintReadOnly, Category = "Leaderboard")
+	int32 PlayerId = INDEX_NONE;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Leaderboard")
+	int32 Score = 0;
+
+	//Scoring hits in a row since the player last lost points
+	UPROPERTY(BlueprintReadOnly, Category = "Leaderboard")
+	uint8 Streak = 0;
+};
+
+USTRUCT()
+struct FCowLeaderboard : public FFastArraySerializer
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TArray<FCowLeaderboardEntry> Items;
+
+	UPROPERTY(NotReplicated)
+	TObjectPtr<UCowLeaderboardComponent> Owner = nullptr;
+
+	void PostReplicatedReceive(const FFastArraySerializer::FPostReplicatedReceiveParameters& Parameters);
+
+	bool NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms)
+	{
+		return FFastArraySerializer::FastArrayDeltaSerialize<FCowLeaderboardEntry, FCowLeaderboard>(Items, DeltaParms, *this);
+	}
+};
+
+template<>
+struct TStructOpsTypeTraits<FCowLeaderboard> : public TStructOpsTypeTraitsBase2<FCowLeaderboard>
+{
+	enum
+	{
+		WithNetDeltaSerializer = true,
+	};
+};
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnLeaderboardChanged);
+
+/**
+ * Match leaderboard shared with every client, lives on the game state. The rows are a fast array, so a score change sends
+ * only the row that changed and clients keep a sorted copy instead of walking every cow.
+ * AMooMooMadnessGameState creates one, AMooMooMadnessGameMode adds one to any other game state class it spawns.
+ * Rows are added, removed and updated by AMooMooMadnessGameMode.
+ */
+UCLASS(ClassGroup=(Score), meta=(BlueprintSpawnableComponent))
+class MOOMOOMADNESS_API UCowLeaderboardComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	UCowLeaderboardComponent();
+
+	/** The leaderboard of the world's game state, null until the game state has replicated */
+	UFUNCTION(BlueprintPure, Category = "Leaderboard", meta = (WorldContext = "WorldContextObject"))
+	static UCowLeaderboardComponent* GetLeaderboard(const UObject* WorldContextObject);
+
+	virtual void InitializeComponent() override;
+
+	/** Adds a row for a player. Server only */
+	void AddEntry(int32 PlayerId, int32 Score);
+
+	/** Removes a player's row. Server only */
+	void RemoveEntry(int32 PlayerId);
+
+	/** Sets a player's score and updates their streak from the change. Server only */
+	void UpdateEntry(int32 PlayerId, int32 Score, int32 Delta);
+
+	/** Leaderboard rows sorted from highest to lowest score */
+	UFUNCTION(BlueprintPure, Category = "Leaderboard")
+	const TArray<FCowLeaderboardEntry>& GetRankings() const { return Rankings; }
+
+	//Broadcast after Rankings is rebuilt, on the server and on every client
+	UPROPERTY(BlueprintAssignable, Category = "Leaderboard")
+	FOnLeaderboardChanged OnLeaderboardChanged;
+
+	/** Called by the leaderboard after a replicated update */
+	void OnLeaderboardReplicated();
+
+protected:
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
+private:
+	void RebuildRankings();
+
+	UPROPERTY(Replicated)
+	FCowLeaderboard Leaderboard;
+
+	//Sorted copy of the leaderboard rows
+	TArray<FCowLeaderboardEntry> Rankings;
+};
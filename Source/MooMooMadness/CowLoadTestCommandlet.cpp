@@ -0,0 +1,177 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CowLoadTestCommandlet.h"
+
+#include "CowLoadTestSubsystem.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformProcess.h"
+#include "Misc/DateTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Parse.h"
+#include "Misc/Paths.h"
+
+//Time the server gets to start listening before the clients try to connect
+static constexpr float ServerStartupTime = 15.f;
+
+//Time the clients get to load the map and join before the measured match starts counting down
+static constexpr float ClientJoinTime = 15.f;
+
+//Extra time on top of the match before hung processes are killed
+static constexpr float ShutdownTimeout = 60.f;
+
+UCowLoadTestCommandlet::UCowLoadTestCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = false;
+	LogToConsole = true;
+}
+
+int32 UCowLoadTestCommandlet::Main(const FString& Params)
+{
+	const TCHAR* CmdLine = *Params;
+
+	int32 NumClients = 4;
+	float Duration = 60.f;
+	int32 PktLag = 0;
+	int32 PktLoss = 0;
+	int32 Port = 7777;
+	FString Map = TEXT("/Game/Levels/L_FeralFarmstead");
+	FParse::Value(CmdLine, TEXT("Clients="), NumClients);
+	FParse::Value(CmdLine, TEXT("Duration="), Duration);
+	FParse::Value(CmdLine, TEXT("PktLag="), PktLag);
+	FParse::Value(CmdLine, TEXT("PktLoss="), PktLoss);
+	FParse::Value(CmdLine, TEXT("Port="), Port);
+	FParse::Value(CmdLine, TEXT("Map="), Map);
+	const bool bDedicated = FParse::Param(CmdLine, TEXT("Dedicated"));
+
+	const FString ReportDir = FPaths::ConvertRelativePathToFull(
+		FPaths::ProjectSavedDir() / TEXT("Profiling") / TEXT("LoadTest") / FDateTime::Now().ToString());
+	IFileManager::Get().MakeDirectory(*ReportDir, true);
+
+	//Every process stops at this wall clock time, however long it took to start
+	const float TimeToEnd = ServerStartupTime + ClientJoinTime + Duration;
+	const int64 EndUnixTime = FDateTime::UtcNow().ToUnixTimestamp() + FMath::CeilToInt64(TimeToEnd);
+
+	const FString ProjectFile = FString::Printf(TEXT("\"%s\""), *FPaths::ConvertRelativePathToFull(FPaths::GetProjectFilePath()));
+	const FString CommonArgs = FString::Printf(TEXT("-nullrhi -nosound -nosteam -unattended -nosplash -log -CowLoadTest -CowLoadTestEnd=%lld -CowLoadTestDir=\"%s\""),
+		EndUnixTime, *ReportDir);
+
+	UE_LOG(LogCowLoadTest, Display, TEXT("Starting %s server on %s with %d clients, %.0fs, %dms lag, %d%% loss"),
+		bDedicated ? TEXT("dedicated") : TEXT("listen"), *Map, NumClients, Duration, PktLag, PktLoss);
+
+	TArray<FProcHandle> Processes;
+
+	const FString ServerArgs = bDedicated
+		? FString::Printf(TEXT("%s %s -server -Port=%d %s"), *ProjectFile, *Map, Port, *CommonArgs)
+		: FString::Printf(TEXT("%s %s?listen -game -Port=%d %s"), *ProjectFile, *Map, Port, *CommonArgs);
+	FProcHandle Server = LaunchProcess(ServerArgs);
+	if (!Server.IsValid())
+	{
+		UE_LOG(LogCowLoadTest, Error, TEXT("Couldn't start the server"));
+		return 1;
+	}
+	Processes.Add(Server);
+
+	FPlatformProcess::Sleep(ServerStartupTime);
+
+	//Lag and loss are simulated on the client side of each connection
+	const FString ClientArgs = FString::Printf(TEXT("%s 127.0.0.1:%d -game -PktLag=%d -PktLoss=%d %s"),
+		*ProjectFile, Port, PktLag, PktLoss, *CommonArgs);
+	for (int32 ClientIndex = 0; ClientIndex < NumClients; ClientIndex++)
+	{
+		FProcHandle Client = LaunchProcess(ClientArgs);
+		if (Client.IsValid())
+		{
+			Processes.Add(Client);
+		}
+		else
+		{
+			UE_LOG(LogCowLoadTest, Warning, TEXT("Couldn't start client %d"), ClientIndex);
+		}
+	}
+
+	const double Deadline = FPlatformTime::Seconds() + (EndUnixTime - FDateTime::UtcNow().ToUnixTimestamp())
+		+ UCowLoadTestSubsystem::ServerGraceTime + ShutdownTimeout;
+	for (FProcHandle& Process : Processes)
+	{
+		while (FPlatformProcess::IsProcRunning(Process) && FPlatformTime::Seconds() < Deadline)
+		{
+			FPlatformProcess::Sleep(1.f);
+		}
+		if (FPlatformProcess::IsProcRunning(Process))
+		{
+			UE_LOG(LogCowLoadTest, Warning, TEXT("Killing a process that didn't exit on its own"));
+			FPlatformProcess::TerminateProc(Process, true);
+		}
+		FPlatformProcess::CloseProc(Process);
+	}
+
+	return WriteSummary(ReportDir) ? 0 : 1;
+}
+
+FProcHandle UCowLoadTestCommandlet::LaunchProcess(const FString& Args) const
+{
+	UE_LOG(LogCowLoadTest, Log, TEXT("Launching %s"), *Args);
+	return FPlatformProcess::CreateProc(FPlatformProcess::ExecutablePath(), *Args, true, false, false, nullptr, 0, nullptr, nullptr);
+}
+
+bool UCowLoadTestCommandlet::WriteSummary(const FString& ReportDir) const
+{
+	TArray<FString> ReportFiles;
+	IFileManager::Get().FindFiles(ReportFiles, *(ReportDir / TEXT("LoadTest-*.csv")), true, false);
+	if (ReportFiles.IsEmpty())
+	{
+		UE_LOG(LogCowLoadTest, Error, TEXT("No reports were written to %s"), *ReportDir);
+		return false;
+	}
+
+	//Numeric rows are averaged per role, so the summary reads the same for 2 clients or 50
+	struct FMetricTotal
+	{
+		double Sum = 0.0;
+		int32 Count = 0;
+	};
+	TMap<FString, FMetricTotal> Totals;
+	TArray<FString> MetricOrder;
+
+	for (const FString& ReportFile : ReportFiles)
+	{
+		TArray<FString> Lines;
+		FFileHelper::LoadFileToStringArray(Lines, *(ReportDir / ReportFile));
+
+		const FString Role = ReportFile.StartsWith(TEXT("LoadTest-Server")) ? TEXT("Server") : TEXT("Client");
+		for (const FString& Line : Lines)
+		{
+			FString Metric, Value;
+			if (!Line.Split(TEXT(","), &Metric, &Value) || !Value.IsNumeric())
+			{
+				continue;
+			}
+
+			const FString Key = Role + TEXT(".") + Metric;
+			if (!Totals.Contains(Key))
+			{
+				MetricOrder.Add(Key);
+			}
+			FMetricTotal& Total = Totals.FindOrAdd(Key);
+			Total.Sum += FCString::Atod(*Value);
+			Total.Count++;
+		}
+	}
+
+	FString Summary = TEXT("Metric,Average,Reports\n");
+	for (const FString& Key : MetricOrder)
+	{
+		const FMetricTotal& Total = Totals[Key];
+		const double Average = Total.Sum/Total.Count;
+		Summary += FString::Printf(TEXT("%s,%.3f,%d\n"), *Key, Average, Total.Count);
+		UE_LOG(LogCowLoadTest, Display, TEXT("%-32s %12.3f"), *Key, Average);
+	}
+
+	const FString SummaryFile = ReportDir / TEXT("Summary.csv");
+	FFileHelper::SaveStringToFile(Summary, *SummaryFile);
+	UE_LOG(LogCowLoadTest, Display, TEXT("%d reports merged into %s"), ReportFiles.Num(), *SummaryFile);
+	return true;
+}
@@ -0,0 +1,34 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "CowLoadTestCommandlet.generated.h"
+
+/**
+ * Boots a server and a number of headless clients on this machine, waits for them to play the match out
+ * and merges their reports into one summary.
+ *
+ * UnrealEditor-Cmd MooMooMadness.uproject -run=CowLoadTest -Clients=8 -Duration=60 -PktLag=100 -PktLoss=2
+ *
+ * Optional: -Map=<map> (defaults to L_FeralFarmstead), -Dedicated for a dedicated server instead of
+ * a listen server, -Port=<port>. Every process runs with -nullrhi and UCowLoadTestSubsystem does the playing.
+ */
+UCLASS()
+class UCowLoadTestCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UCowLoadTestCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+
+private:
+	/** Starts one game process, returns an invalid handle if it couldn't */
+	FProcHandle LaunchProcess(const FString& Args) const;
+
+	/** Averages the report rows of every file in ReportDir into Summary.csv, returns false if there were none */
+	bool WriteSummary(const FString& ReportDir) const;
+};
@@ -0,0 +1,283 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CowLoadTestSubsystem.h"
+
+#include "CowMovementComponent.h"
+#include "CowNetStatsSubsystem.h"
+#include "Engine/NetDriver.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "HAL/PlatformMisc.h"
+#include "HAL/PlatformProcess.h"
+#include "InputActionValue.h"
+#include "Misc/CommandLine.h"
+#include "Misc/DateTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Parse.h"
+#include "Misc/Paths.h"
+#include "MooMooMadnessCharacter.h"
+#include "MooMooMadnessPlayerState.h"
+
+DEFINE_LOG_CATEGORY(LogCowLoadTest);
+
+//Set once this process has written its report, later worlds (the menu a dropped client travels back to) don't start another run
+static bool bProcessReported = false;
+
+//A timed headbutt that hasn't scored after this long is a miss
+static constexpr double MaxHitToScoreTime = 2.0;
+
+/** Min, mean, 95th percentile and max of Samples as report rows */
+static void AppendDistribution(FString& Report, const TCHAR* Metric, TArray<float> Samples)
+{
+	if (Samples.IsEmpty())
+	{
+		Report += FString::Printf(TEXT("%sSamples,0\n"), Metric);
+		return;
+	}
+
+	Samples.Sort();
+	double Sum = 0.0;
+	for (const float Sample : Samples)
+	{
+		Sum += Sample;
+	}
+	const int32 P95Index = FMath::Min(Samples.Num() - 1, FMath::FloorToInt32(Samples.Num()*0.95f));
+
+	Report += FString::Printf(TEXT("%sSamples,%d\n"), Metric, Samples.Num());
+	Report += FString::Printf(TEXT("%sMin,%.3f\n"), Metric, Samples[0]);
+	Report += FString::Printf(TEXT("%sAvg,%.3f\n"), Metric, Sum/Samples.Num());
+	Report += FString::Printf(TEXT("%sP95,%.3f\n"), Metric, Samples[P95Index]);
+	Report += FString::Printf(TEXT("%sMax,%.3f\n"), Metric, Samples.Last());
+}
+
+bool UCowLoadTestSubsystem::IsLoadTestRun()
+{
+	return FParse::Param(FCommandLine::Get(), TEXT("CowLoadTest"));
+}
+
+bool UCowLoadTestSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+#if UE_BUILD_SHIPPING
+	return false;
+#else
+	return IsLoadTestRun() && !bProcessReported && Super::ShouldCreateSubsystem(Outer);
+#endif
+}
+
+bool UCowLoadTestSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game;
+}
+
+void UCowLoadTestSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	FParse::Value(FCommandLine::Get(), TEXT("CowLoadTestDuration="), Duration);
+	FParse::Value(FCommandLine::Get(), TEXT("CowLoadTestEnd="), EndUnixTime);
+	if (!FParse::Value(FCommandLine::Get(), TEXT("CowLoadTestDir="), ReportDir))
+	{
+		ReportDir = FPaths::ProjectSavedDir() / TEXT("Profiling") / TEXT("LoadTest");
+	}
+
+	//Every client would walk the same path with the same seed
+	Random.Initialize(FPlatformProcess::GetCurrentProcessId());
+
+	TickStartHandle = FWorldDelegates::OnWorldTickStart.AddUObject(this, &UCowLoadTestSubsystem::OnWorldTickStart);
+	PostActorTickHandle = FWorldDelegates::OnWorldPostActorTick.AddUObject(this, &UCowLoadTestSubsystem::OnWorldPostActorTick);
+}
+
+void UCowLoadTestSubsystem::Deinitialize()
+{
+	FWorldDelegates::OnWorldTickStart.Remove(TickStartHandle);
+	FWorldDelegates::OnWorldPostActorTick.Remove(PostActorTickHandle);
+
+	//Clients that lose the server early still leave a report behind, then leave instead of idling in the menu
+	if (!bFinished && BeginPlayTime > 0.0)
+	{
+		bFinished = true;
+		WriteReport();
+		FPlatformMisc::RequestExit(false);
+	}
+
+	Super::Deinitialize();
+}
+
+void UCowLoadTestSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	BeginPlayTime = FPlatformTime::Seconds();
+
+	//Processes start seconds apart, the shared end time keeps the server from leaving before its clients
+	StopTime = EndUnixTime > 0
+		? BeginPlayTime + (EndUnixTime - FDateTime::UtcNow().ToUnixTimestamp())
+		: BeginPlayTime + Duration;
+}
+
+TStatId UCowLoadTestSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UCowLoadTestSubsystem, STATGROUP_Tickables);
+}
+
+void UCowLoadTestSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	UWorld* World = GetWorld();
+	if (bFinished || BeginPlayTime <= 0.0 || !World)
+	{
+		return;
+	}
+
+	const bool bServer = World->GetNetMode() != NM_Client;
+	const double Now = FPlatformTime::Seconds();
+	if (Now >= StopTime + (bServer ? ServerGraceTime : 0.f))
+	{
+		bFinished = true;
+		WriteReport();
+		FPlatformMisc::RequestExit(false);
+		return;
+	}
+
+	//Dedicated servers have no cow to drive, a listen server plays along with its clients
+	if (Now < StopTime && World->GetNetMode() != NM_DedicatedServer)
+	{
+		APlayerController* PlayerController = World->GetFirstPlayerController();
+		if (AMooMooMadnessCharacter* Cow = PlayerController ? Cast<AMooMooMadnessCharacter>(PlayerController->GetPawn()) : nullptr)
+		{
+			CheckScore(Cow);
+			DriveCow(Cow, DeltaTime);
+		}
+	}
+}
+
+void UCowLoadTestSubsystem::DriveCow(AMooMooMadnessCharacter* Cow, float DeltaTime)
+{
+	const float Now = GetWorld()->GetTimeSeconds();
+	AController* Controller = Cow->GetController();
+
+	if (Now >= NextTurnTime)
+	{
+		MoveYaw = Random.FRandRange(-180.f, 180.f);
+		NextTurnTime = Now + Random.FRandRange(1.f, 3.f);
+	}
+	Controller->SetControlRotation(FRotator(0.f, MoveYaw, 0.f));
+	Cow->Move(FInputActionValue(FVector2D(0.f, 1.f)));
+	MoveInputs++;
+
+	//Only headbutts are timed, and nothing else that can score starts while one is pending,
+	//so a score change belongs to the headbutt it is measured from
+	const bool bAttackPending = PendingAttackTime >= 0.0;
+	const bool bSprinting = Cow->GetCowMovement()->IsSprinting();
+
+	if (Now >= NextSprintToggleTime && (bSprinting || !bAttackPending))
+	{
+		if (bSprinting)
+		{
+			Cow->StopSprinting();
+		}
+		else
+		{
+			Cow->Sprint();
+			SprintInputs++;
+		}
+		NextSprintToggleTime = Now + Random.FRandRange(0.5f, 2.f);
+	}
+
+	if (Now >= NextHeadbuttTime && !bAttackPending)
+	{
+		Cow->ReleaseHeadButt();
+		HeadbuttInputs++;
+		//A charge already under way could land first, those headbutts go out untimed
+		if (!bSprinting)
+		{
+			PendingAttackTime = FPlatformTime::Seconds();
+		}
+		NextHeadbuttTime = Now + Random.FRandRange(0.75f, 1.5f);
+	}
+}
+
+void UCowLoadTestSubsystem::CheckScore(AMooMooMadnessCharacter* Cow)
+{
+	const AMooMooMadnessPlayerState* PlayerState = Cow->GetPlayerState<AMooMooMadnessPlayerState>();
+	if (!PlayerState)
+	{
+		return;
+	}
+
+	const int32 Points = PlayerState->GetPoints();
+	if (PendingAttackTime >= 0.0)
+	{
+		const double Latency = FPlatformTime::Seconds() - PendingAttackTime;
+		if (Points > LastPoints && Latency <= MaxHitToScoreTime)
+		{
+			HitToScoreMs.Add(Latency*1000.0);
+			PendingAttackTime = -1.0;
+		}
+		else if (Latency > MaxHitToScoreTime)
+		{
+			//Missed, free the cow up for the next timed headbutt
+			PendingAttackTime = -1.0;
+		}
+	}
+	LastPoints = Points;
+}
+
+void UCowLoadTestSubsystem::OnWorldTickStart(UWorld* InWorld, ELevelTick TickType, float DeltaSeconds)
+{
+	if (InWorld == GetWorld())
+	{
+		TickStartTime = FPlatformTime::Seconds();
+	}
+}
+
+void UCowLoadTestSubsystem::OnWorldPostActorTick(UWorld* InWorld, ELevelTick TickType, float DeltaSeconds)
+{
+	if (InWorld == GetWorld() && TickStartTime > 0.0 && BeginPlayTime > 0.0)
+	{
+		TickMs.Add((FPlatformTime::Seconds() - TickStartTime)*1000.0);
+	}
+}
+
+FString UCowLoadTestSubsystem::WriteReport() const
+{
+	const UWorld* World = GetWorld();
+	if (!World)
+	{
+		return FString();
+	}
+
+	const bool bServer = World->GetNetMode() != NM_Client;
+	const UNetDriver* NetDriver = World->GetNetDriver();
+
+	FString Report = TEXT("Metric,Value\n");
+	Report += FString::Printf(TEXT("Role,%s\n"), bServer ? TEXT("Server") : TEXT("Client"));
+	Report += FString::Printf(TEXT("Seconds,%.1f\n"), FPlatformTime::Seconds() - BeginPlayTime);
+	Report += FString::Printf(TEXT("Connections,%d\n"), NetDriver ? NetDriver->ClientConnections.Num() : 0);
+	Report += FString::Printf(TEXT("MoveInputs,%d\n"), MoveInputs);
+	Report += FString::Printf(TEXT("SprintInputs,%d\n"), SprintInputs);
+	Report += FString::Printf(TEXT("HeadbuttInputs,%d\n"), HeadbuttInputs);
+	AppendDistribution(Report, TEXT("HitToScoreMs"), HitToScoreMs);
+	AppendDistribution(Report, TEXT("TickMs"), TickMs);
+
+	//Per function counts are in the net stats CSV, the report only carries the total and where to find them
+	if (const UCowNetStatsSubsystem* NetStats = World->GetSubsystem<UCowNetStatsSubsystem>())
+	{
+		Report += FString::Printf(TEXT("RPCsSent,%llu\n"), NetStats->GetTotalCalls());
+		Report += FString::Printf(TEXT("RPCStatsFile,%s\n"), *NetStats->ExportCsv());
+	}
+
+	const FString FileName = ReportDir / FString::Printf(TEXT("LoadTest-%s-%u-%s.csv"),
+		bServer ? TEXT("Server") : TEXT("Client"), FPlatformProcess::GetCurrentProcessId(), *FDateTime::Now().ToString());
+	if (!FFileHelper::SaveStringToFile(Report, *FileName))
+	{
+		UE_LOG(LogCowLoadTest, Warning, TEXT("Couldn't write load test report to %s"), *FileName);
+		return FString();
+	}
+
+	bProcessReported = true;
+	UE_LOG(LogCowLoadTest, Log, TEXT("Wrote load test report to %s"), *FileName);
+	return FileName;
+}
@@ -0,0 +1,98 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "CowLoadTestSubsystem.generated.h"
+
+class AMooMooMadnessCharacter;
+
+DECLARE_LOG_CATEGORY_EXTERN(LogCowLoadTest, Log, All);
+
+/**
+ * Runs one process of a headless load test, only created when the game is started with -CowLoadTest.
+ * Clients drive their cow with scripted Move, Sprint and ReleaseHeadButt inputs and time how long
+ * an attack takes to show up in their replicated score. The server times its own ticks.
+ * Every process stops at the same wall clock time, -CowLoadTestEnd as a UTC unix timestamp (the server ServerGraceTime
+ * later), or -CowLoadTestDuration after its own BeginPlay when run by hand. It then writes a report to -CowLoadTestDir
+ * and exits. A process that loses its match early reports what it has and exits instead of starting over in the menu.
+ * UCowLoadTestCommandlet launches the processes and merges the reports.
+ */
+UCLASS()
+class MOOMOOMADNESS_API UCowLoadTestSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	/** Whether this process was started as part of a load test */
+	static bool IsLoadTestRun();
+
+	//The server keeps going after the clients stop so their last attacks can still score
+	static constexpr float ServerGraceTime = 10.f;
+
+	/** Writes the report for this process, returns the file written or an empty string */
+	FString WriteReport() const;
+
+protected:
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+	/** Feeds this frame's scripted input to the locally controlled cow */
+	void DriveCow(AMooMooMadnessCharacter* Cow, float DeltaTime);
+
+	/** Records how long the last attack took to score, if the score went up */
+	void CheckScore(AMooMooMadnessCharacter* Cow);
+
+	void OnWorldTickStart(UWorld* InWorld, ELevelTick TickType, float DeltaSeconds);
+	void OnWorldPostActorTick(UWorld* InWorld, ELevelTick TickType, float DeltaSeconds);
+
+	FDelegateHandle TickStartHandle;
+	FDelegateHandle PostActorTickHandle;
+
+	//Seconds the test runs for once the world begins play, only used without -CowLoadTestEnd
+	float Duration = 60.f;
+
+	//UTC unix time the clients stop at, 0 when not given
+	int64 EndUnixTime = 0;
+
+	//FPlatformTime::Seconds at which the clients stop driving, worked out at BeginPlay
+	double StopTime = 0.0;
+
+	FString ReportDir;
+
+	double BeginPlayTime = 0.0;
+
+	//Set once the report is written so the exit request isn't repeated
+	bool bFinished = false;
+
+	FRandomStream Random;
+
+	//Yaw the scripted cow is currently running towards
+	float MoveYaw = 0.f;
+	float NextTurnTime = 0.f;
+	float NextSprintToggleTime = 0.f;
+	float NextHeadbuttTime = 0.f;
+
+	//Time of the headbutt being timed, negative when there isn't one. Cleared when it scores or misses
+	double PendingAttackTime = -1.0;
+	int32 LastPoints = 0;
+
+	int32 MoveInputs = 0;
+	int32 SprintInputs = 0;
+	int32 HeadbuttInputs = 0;
+
+	//Headbutt to score latencies, in milliseconds
+	TArray<float> HitToScoreMs;
+
+	//Game thread time spent in each world tick, in milliseconds
+	double TickStartTime = 0.0;
+	TArray<float> TickMs;
+};
@@ -0,0 +1,193 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CowMovementComponent.h"
+
+#include "MooMooMadnessCharacter.h"
+#include "GameFramework/RootMotionSource.h"
+
+static const FName HeadbuttRootMotionName = "CowHeadbutt";
+
+/** Saved move that remembers whether sprint was held and whether a headbutt started on this move */
+class FSavedMove_Cow : public FSavedMove_Character
+{
+public:
+	typedef FSavedMove_Character Super;
+
+	virtual void Clear() override
+	{
+		Super::Clear();
+		bSavedWantsToSprint = false;
+		bSavedWantsToHeadbutt = false;
+	}
+
+	virtual uint8 GetCompressedFlags() const override
+	{
+		uint8 Result = Super::GetCompressedFlags();
+		if (bSavedWantsToSprint)
+		{
+			Result |= FLAG_Custom_0;
+		}
+		if (bSavedWantsToHeadbutt)
+		{
+			Result |= FLAG_Custom_1;
+		}
+		return Result;
+	}
+
+	virtual bool CanCombineWith(const FSavedMovePtr& NewMove, ACharacter* InCharacter, float MaxDelta) const override
+	{
+		const FSavedMove_Cow* NewCowMove = static_cast<const FSavedMove_Cow*>(NewMove.Get());
+		if (bSavedWantsToSprint != NewCowMove->bSavedWantsToSprint || bSavedWantsToHeadbutt || NewCowMove->bSavedWantsToHeadbutt)
+		{
+			return false;
+		}
+		return Super::CanCombineWith(NewMove, InCharacter, MaxDelta);
+	}
+
+	virtual void SetMoveFor(ACharacter* C, float InDeltaTime, FVector const& NewAccel, FNetworkPredictionData_Client_Character& ClientData) override
+	{
+		Super::SetMoveFor(C, InDeltaTime, NewAccel, ClientData);
+		const UCowMovementComponent* Movement = CastChecked<UCowMovementComponent>(C->GetCharacterMovement());
+		bSavedWantsToSprint = Movement->bWantsToSprint;
+		bSavedWantsToHeadbutt = Movement->bWantsToHeadbutt;
+	}
+
+	virtual void PrepMoveFor(ACharacter* C) override
+	{
+		Super::PrepMoveFor(C);
+		UCowMovementComponent* Movement = CastChecked<UCowMovementComponent>(C->GetCharacterMovement());
+		Movement->bWantsToSprint = bSavedWantsToSprint;
+		Movement->bWantsToHeadbutt = bSavedWantsToHeadbutt;
+	}
+
+	bool bSavedWantsToSprint = false;
+	bool bSavedWantsToHeadbutt = false;
+};
+
+class FNetworkPredictionData_Client_Cow : public FNetworkPredictionData_Client_Character
+{
+public:
+	typedef FNetworkPredictionData_Client_Character Super;
+
+	FNetworkPredictionData_Client_Cow(const UCharacterMovementComponent& ClientMovement)
+		: Super(ClientMovement)
+	{
+	}
+
+	virtual FSavedMovePtr AllocateNewMove() override
+	{
+		return FSavedMovePtr(new FSavedMove_Cow());
+	}
+};
+
+UCowMovementComponent::UCowMovementComponent()
+{
+	MaxSprintSpeed = 650.f;
+	bWantsToSprint = false;
+	bWantsToHeadbutt = false;
+	bNotifiedSprinting = false;
+}
+
+void UCowMovementComponent::SetWantsToSprint(bool bSprint)
+{
+	bWantsToSprint = bSprint;
+}
+
+void UCowMovementComponent::RequestHeadbutt()
+{
+	bWantsToHeadbutt = true;
+}
+
+bool UCowMovementComponent::IsHeadbutting() const
+{
+	return CurrentRootMotion.GetRootMotionSource(HeadbuttRootMotionName).IsValid();
+}
+
+float UCowMovementComponent::GetMaxSpeed() const
+{
+	//Sprinting used to replace MaxWalkSpeed, which also limits air control
+	if (bWantsToSprint && (IsMovingOnGround() || IsFalling()))
+	{
+		return MaxSprintSpeed;
+	}
+	return Super::GetMaxSpeed();
+}
+
+void UCowMovementComponent::UpdateFromCompressedFlags(uint8 Flags)
+{
+	Super::UpdateFromCompressedFlags(Flags);
+
+	bWantsToSprint = (Flags & FSavedMove_Character::FLAG_Custom_0) != 0;
+	bWantsToHeadbutt = (Flags & FSavedMove_Character::FLAG_Custom_1) != 0;
+}
+
+FNetworkPredictionData_Client* UCowMovementComponent::GetPredictionData_Client() const
+{
+	if (ClientPredictionData == nullptr)
+	{
+		UCowMovementComponent* MutableThis = const_cast<UCowMovementComponent*>(this);
+		MutableThis->ClientPredictionData = new FNetworkPredictionData_Client_Cow(*this);
+	}
+	return ClientPredictionData;
+}
+
+void UCowMovementComponent::OnMovementUpdated(float DeltaSeconds, const FVector& OldLocation, const FVector& OldVelocity)
+{
+	Super::OnMovementUpdated(DeltaSeconds, OldLocation, OldVelocity);
+
+	//Let the server open and close the charge attack as it replays the client's moves
+	if (CharacterOwner && CharacterOwner->HasAuthority() && bWantsToSprint != bNotifiedSprinting)
+	{
+		bNotifiedSprinting = bWantsToSprint;
+		if (AMooMooMadnessCharacter* Cow = Cast<AMooMooMadnessCharacter>(CharacterOwner))
+		{
+			Cow->OnSprintChanged(bWantsToSprint);
+		}
+	}
+}
+
+void UCowMovementComponent::UpdateCharacterStateBeforeMovement(float DeltaSeconds)
+{
+	Super::UpdateCharacterStateBeforeMovement(DeltaSeconds);
+
+	if (bWantsToHeadbutt)
+	{
+		bWantsToHeadbutt = false;
+
+		//The flag comes straight from the client's move, the server decides whether the lunge is allowed
+		AMooMooMadnessCharacter* Cow = Cast<AMooMooMadnessCharacter>(CharacterOwner);
+		if (Cow && (!Cow->HasAuthority() || Cow->ServerAcceptHeadbutt()))
+		{
+			StartHeadbutt();
+		}
+	}
+}
+
+void UCowMovementComponent::StartHeadbutt()
+{
+	AMooMooMadnessCharacter* Cow = Cast<AMooMooMadnessCharacter>(CharacterOwner);
+	if (!Cow) { return; }
+
+	//Replaying a corrected move starts the lunge again from that move
+	RemoveRootMotionSource(HeadbuttRootMotionName);
+
+	const FCowAttackKernel& Kernel = Cow->GetAttackKernel(ECowAttack::Headbutt);
+	TSharedPtr<FRootMotionSource_ConstantForce> Lunge = MakeShared<FRootMotionSource_ConstantForce>();
+	Lunge->InstanceName = HeadbuttRootMotionName;
+	Lunge->AccumulateMode = ERootMotionAccumulateMode::Override;
+	Lunge->Priority = 5;
+	Lunge->Force = Cow->GetActorForwardVector()*Kernel.LaunchSpeed;
+	Lunge->Duration = Kernel.LaunchDuration;
+	//Only drive the horizontal velocity so the cow still falls, like the old LaunchCharacter call
+	Lunge->Settings.SetFlag(ERootMotionSourceSettingsFlags::IgnoreZAccumulate);
+	//Come out of the lunge at walking speed instead of stopping dead
+	Lunge->FinishVelocityParams.Mode = ERootMotionFinishVelocityMode::ClampVelocity;
+	Lunge->FinishVelocityParams.ClampVelocity = MaxWalkSpeed;
+	ApplyRootMotionSource(Lunge);
+
+	if (Cow->HasAuthority())
+	{
+		Cow->OnHeadbuttStarted();
+	}
+}
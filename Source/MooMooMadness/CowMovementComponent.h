@@ -0,0 +1,58 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "CowMovementComponent.generated.h"
+
+/**
+ * Character movement with client predicted sprinting and headbutt lunges.
+ * Both inputs travel to the server inside the saved move's compressed flags instead of through RPCs,
+ * so the owning client reacts immediately and the server replays the same movement when it checks the move.
+ */
+UCLASS()
+class MOOMOOMADNESS_API UCowMovementComponent : public UCharacterMovementComponent
+{
+	GENERATED_BODY()
+
+public:
+	UCowMovementComponent();
+
+	/** Starts or stops sprinting on the locally controlled cow */
+	void SetWantsToSprint(bool bSprint);
+
+	FORCEINLINE bool IsSprinting() const { return bWantsToSprint; }
+
+	/** Lunges forward on the next move of the locally controlled cow */
+	void RequestHeadbutt();
+
+	/** Whether the headbutt lunge root motion is still playing */
+	bool IsHeadbutting() const;
+
+	virtual float GetMaxSpeed() const override;
+	virtual void UpdateFromCompressedFlags(uint8 Flags) override;
+	virtual FNetworkPredictionData_Client* GetPredictionData_Client() const override;
+
+	//Max ground speed while sprinting, MaxWalkSpeed is used otherwise
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Character Movement: Sprint", meta = (ClampMin = "0", UIMin = "0", ForceUnits = "cm/s"))
+	float MaxSprintSpeed;
+
+protected:
+	virtual void OnMovementUpdated(float DeltaSeconds, const FVector& OldLocation, const FVector& OldVelocity) override;
+	virtual void UpdateCharacterStateBeforeMovement(float DeltaSeconds) override;
+
+private:
+	friend class FSavedMove_Cow;
+
+	/** Applies the lunge as a constant force root motion source */
+	void StartHeadbutt();
+
+	uint8 bWantsToSprint : 1;
+
+	//Set by input, consumed by the next move
+	uint8 bWantsToHeadbutt : 1;
+
+	//Last sprint state the owner was told about on the server
+	uint8 bNotifiedSprinting : 1;
+};
@@ -0,0 +1,126 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CowNetPriorityComponent.h"
+
+#include "MooMooMadnessCharacter.h"
+#include "MooMooMadnessReplicationGraph.h"
+#include "Engine/NetDriver.h"
+#include "GameFramework/PlayerController.h"
+
+// Sets default values for this component's properties
+UCowNetPriorityComponent::UCowNetPriorityComponent()
+{
+	//Tick is only enabled on the server, see BeginPlay. The owner pushes attacks and stuns through RefreshActivity,
+	//so ticking only has to catch cows settling down or moving away from everyone
+	PrimaryComponentTick.bCanEverTick = true;
+	PrimaryComponentTick.bStartWithTickEnabled = false;
+	PrimaryComponentTick.TickInterval = 0.2f;
+}
+
+// Called when the game starts
+void UCowNetPriorityComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	OwnerCow = Cast<AMooMooMadnessCharacter>(GetOwner());
+	if (!OwnerCow || !OwnerCow->HasAuthority())
+	{
+		return;
+	}
+
+	//Adaptive net update frequency can slow a quiet cow down further, but never below the lowest tier, the distant rate
+	OwnerCow->MinNetUpdateFrequency = FMath::Min(IdleNetUpdateFrequency, DistantNetUpdateFrequency);
+	ApplyActivity(EvaluateActivity());
+	SetComponentTickEnabled(true);
+}
+
+void UCowNetPriorityComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	ApplyActivity(EvaluateActivity());
+}
+
+void UCowNetPriorityComponent::RefreshActivity()
+{
+	if (IsComponentTickEnabled())
+	{
+		ApplyActivity(EvaluateActivity());
+	}
+}
+
+ECowNetActivity UCowNetPriorityComponent::EvaluateActivity() const
+{
+	const UCowMovementComponent* Movement = OwnerCow->GetCowMovement();
+	if (Movement->IsSprinting() || Movement->IsHeadbutting() || OwnerCow->IsStunned())
+	{
+		return ECowNetActivity::Active;
+	}
+	if (!IsNearAnyViewer())
+	{
+		return ECowNetActivity::Distant;
+	}
+	return Movement->Velocity.SizeSquared() < FMath::Square(IdleSpeed) ? ECowNetActivity::Idle : ECowNetActivity::Moving;
+}
+
+bool UCowNetPriorityComponent::IsNearAnyViewer() const
+{
+	const FVector CowLocation = OwnerCow->GetActorLocation();
+	const float RangeSquared = FMath::Square(DistantViewerRange);
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		const APlayerController* PlayerController = It->Get();
+		if (!PlayerController || PlayerController == OwnerCow->GetController())
+		{
+			continue;
+		}
+
+		FVector ViewLocation;
+		FRotator ViewRotation;
+		PlayerController->GetPlayerViewPoint(ViewLocation, ViewRotation);
+		if (FVector::DistSquared(ViewLocation, CowLocation) < RangeSquared)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+void UCowNetPriorityComponent::ApplyActivity(ECowNetActivity NewActivity)
+{
+	if (NewActivity == Activity && OwnerCow->NetUpdateFrequency == GetFrequencyForActivity(Activity))
+	{
+		return;
+	}
+
+	const bool bBecameActive = NewActivity == ECowNetActivity::Active && Activity != ECowNetActivity::Active;
+	Activity = NewActivity;
+
+	//The legacy path reads the actor's frequency, the replication graph keeps its own per actor period
+	const float Frequency = GetFrequencyForActivity(Activity);
+	OwnerCow->NetUpdateFrequency = Frequency;
+	if (const UNetDriver* NetDriver = GetWorld()->GetNetDriver())
+	{
+		if (UMooMooMadnessReplicationGraph* RepGraph = Cast<UMooMooMadnessReplicationGraph>(NetDriver->GetReplicationDriver()))
+		{
+			RepGraph->SetActorNetUpdateFrequency(OwnerCow, Frequency);
+		}
+	}
+
+	if (bBecameActive)
+	{
+		OwnerCow->ForceNetUpdate();
+	}
+}
+
+float UCowNetPriorityComponent::GetFrequencyForActivity(ECowNetActivity InActivity) const
+{
+	switch (InActivity)
+	{
+		case ECowNetActivity::Active:	return ActiveNetUpdateFrequency;
+		case ECowNetActivity::Moving:	return MovingNetUpdateFrequency;
+		case ECowNetActivity::Idle:		return IdleNetUpdateFrequency;
+		default:						return DistantNetUpdateFrequency;
+	}
+}
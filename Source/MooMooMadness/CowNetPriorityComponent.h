@@ -0,0 +1,77 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "CowNetPriorityComponent.generated.h"
+
+class AMooMooMadnessCharacter;
+
+/** How busy a cow is, from the replication point of view */
+enum class ECowNetActivity : uint8
+{
+	Distant,	//No other player is close enough to care
+	Idle,		//Standing still
+	Moving,
+	Active,		//Sprinting, lunging or stunned
+};
+
+/**
+ * Server-side controller for a cow's net update rate. Cows that are sprinting, lunging or stunned
+ * replicate at the full rate, idle cows and cows nobody else is near drop to a fraction of it.
+ * Entering the active state forces an update so the start of an attack goes out right away.
+ */
+UCLASS(ClassGroup=(Network), meta=(BlueprintSpawnableComponent))
+class MOOMOOMADNESS_API UCowNetPriorityComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	// Sets default values for this component's properties
+	UCowNetPriorityComponent();
+
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+	/** Re-evaluates the update rate right away, called by the owner when it starts or stops an attack or a stun */
+	void RefreshActivity();
+
+protected:
+	// Called when the game starts
+	virtual void BeginPlay() override;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Net Priority", meta = (ClampMin = "1", ForceUnits = "Hz"))
+	float ActiveNetUpdateFrequency = 60.f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Net Priority", meta = (ClampMin = "1", ForceUnits = "Hz"))
+	float MovingNetUpdateFrequency = 30.f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Net Priority", meta = (ClampMin = "1", ForceUnits = "Hz"))
+	float IdleNetUpdateFrequency = 10.f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Net Priority", meta = (ClampMin = "1", ForceUnits = "Hz"))
+	float DistantNetUpdateFrequency = 4.f;
+
+	//Cows further than this from every other player's view point count as distant, unless active
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Net Priority", meta = (ClampMin = "0", ForceUnits = "cm"))
+	float DistantViewerRange = 6000.f;
+
+	//Below this speed the cow counts as idle
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Net Priority", meta = (ClampMin = "0", ForceUnits = "cm/s"))
+	float IdleSpeed = 10.f;
+
+private:
+	ECowNetActivity EvaluateActivity() const;
+
+	/** Whether any player other than the owner has a view point within DistantViewerRange */
+	bool IsNearAnyViewer() const;
+
+	void ApplyActivity(ECowNetActivity NewActivity);
+
+	float GetFrequencyForActivity(ECowNetActivity InActivity) const;
+
+	UPROPERTY()
+	AMooMooMadnessCharacter* OwnerCow;
+
+	ECowNetActivity Activity = ECowNetActivity::Active;
+};
@@ -0,0 +1,281 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CowNetStatsSubsystem.h"
+
+#include "Engine/ActorChannel.h"
+#include "Engine/Channel.h"
+#include "Engine/NetConnection.h"
+#include "Engine/NetDriver.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Net/RepLayout.h"
+#include "ProfilingDebugging/CsvProfiler.h"
+#include "Trace/Trace.inl"
+
+DECLARE_STATS_GROUP(TEXT("MooNet"), STATGROUP_MooNet, STATCAT_Advanced);
+DECLARE_DWORD_COUNTER_STAT(TEXT("RPCs Sent"), STAT_MooNetRPCs, STATGROUP_MooNet);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Reliable RPCs Sent"), STAT_MooNetReliableRPCs, STATGROUP_MooNet);
+DECLARE_DWORD_COUNTER_STAT(TEXT("RPC Payload Bytes"), STAT_MooNetPayloadBytes, STATGROUP_MooNet);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Peak Reliable Buffer"), STAT_MooNetPeakReliableBuffer, STATGROUP_MooNet);
+
+CSV_DEFINE_CATEGORY(MooNet, true);
+
+UE_TRACE_CHANNEL_DEFINE(MooNetChannel);
+
+UE_TRACE_EVENT_BEGIN(MooNet, RPCSent)
+	UE_TRACE_EVENT_FIELD(uint64, Cycle)
+	UE_TRACE_EVENT_FIELD(uint32, ConnectionId)
+	UE_TRACE_EVENT_FIELD(uint32, PayloadBits)
+	UE_TRACE_EVENT_FIELD(bool, bReliable)
+	UE_TRACE_EVENT_FIELD(UE::Trace::WideString, FunctionName)
+UE_TRACE_EVENT_END()
+
+static FAutoConsoleCommandWithWorld ExportNetStatsCommand(
+	TEXT("moo.NetStats.Export"),
+	TEXT("Writes the RPC and connection stats gathered so far to Saved/Profiling/MooNet."),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		if (const UCowNetStatsSubsystem* NetStats = World ? World->GetSubsystem<UCowNetStatsSubsystem>() : nullptr)
+		{
+			NetStats->ExportCsv();
+		}
+	}));
+
+bool UCowNetStatsSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+#if UE_BUILD_SHIPPING
+	return false;
+#else
+	return Super::ShouldCreateSubsystem(Outer);
+#endif
+}
+
+bool UCowNetStatsSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UCowNetStatsSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+#if !UE_BUILD_SHIPPING
+	//Standalone worlds have no driver, and the send hook only takes one listener
+	UNetDriver* NetDriver = InWorld.GetNetDriver();
+	if (NetDriver && !NetDriver->SendRPCDel.IsBound())
+	{
+		NetDriver->SendRPCDel.BindUObject(this, &UCowNetStatsSubsystem::OnSendRPC);
+		HookedDriver = NetDriver;
+	}
+#endif
+}
+
+void UCowNetStatsSubsystem::Deinitialize()
+{
+#if !UE_BUILD_SHIPPING
+	//Leaving the map is the end of the match
+	ExportCsv();
+
+	if (UNetDriver* NetDriver = HookedDriver.Get())
+	{
+		NetDriver->SendRPCDel.Unbind();
+	}
+	HookedDriver.Reset();
+	Connections.Reset();
+#endif
+
+	Super::Deinitialize();
+}
+
+TStatId UCowNetStatsSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UCowNetStatsSubsystem, STATGROUP_Tickables);
+}
+
+#if !UE_BUILD_SHIPPING
+void UCowNetStatsSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	SET_DWORD_STAT(STAT_MooNetRPCs, FrameCalls);
+	SET_DWORD_STAT(STAT_MooNetReliableRPCs, FrameReliableCalls);
+	SET_DWORD_STAT(STAT_MooNetPayloadBytes, FMath::DivideAndRoundUp(FramePayloadBits, 8u));
+	CSV_CUSTOM_STAT(MooNet, RPCs, (int32)FrameCalls, ECsvCustomStatOp::Set);
+	CSV_CUSTOM_STAT(MooNet, ReliableRPCs, (int32)FrameReliableCalls, ECsvCustomStatOp::Set);
+	FrameCalls = 0;
+	FrameReliableCalls = 0;
+	FramePayloadBits = 0;
+
+	const UNetDriver* NetDriver = HookedDriver.Get();
+	if (!NetDriver) { return; }
+
+	//Sample the buffers once a frame, that's enough to catch a connection backing up
+	int32 FramePeakReliableBuffer = 0;
+	auto SampleConnection = [this, &FramePeakReliableBuffer](UNetConnection* Connection)
+	{
+		int32 ReliableBuffer = 0;
+		for (const UChannel* Channel : Connection->OpenChannels)
+		{
+			if (Channel)
+			{
+				ReliableBuffer = FMath::Max(ReliableBuffer, Channel->NumOutRec);
+			}
+		}
+
+		FConnectionStats& Stats = FindOrAddConnection(Connection);
+		Stats.PeakReliableBuffer = FMath::Max(Stats.PeakReliableBuffer, ReliableBuffer);
+		Stats.PeakOutBytesPerSecond = FMath::Max(Stats.PeakOutBytesPerSecond, Connection->OutBytesPerSecond);
+		FramePeakReliableBuffer = FMath::Max(FramePeakReliableBuffer, ReliableBuffer);
+	};
+
+	if (NetDriver->ServerConnection)
+	{
+		SampleConnection(NetDriver->ServerConnection);
+	}
+	for (UNetConnection* Connection : NetDriver->ClientConnections)
+	{
+		SampleConnection(Connection);
+	}
+
+	SET_DWORD_STAT(STAT_MooNetPeakReliableBuffer, FramePeakReliableBuffer);
+	CSV_CUSTOM_STAT(MooNet, PeakReliableBuffer, FramePeakReliableBuffer, ECsvCustomStatOp::Set);
+}
+
+void UCowNetStatsSubsystem::OnSendRPC(AActor* Actor, UFunction* Function, void* Parameters, FOutParmRec* OutParms, FFrame* Stack, UObject* SubObject, bool& bBlockSendRPC)
+{
+	if (!Actor || !Function) { return; }
+
+	const bool bReliable = Function->HasAnyFunctionFlags(FUNC_NetReliable);
+	const UNetDriver* NetDriver = HookedDriver.Get();
+
+	//Multicasts go to every client connection the actor is open on, everything else to the owner
+	if (Function->HasAnyFunctionFlags(FUNC_NetMulticast) && NetDriver)
+	{
+		for (UNetConnection* Connection : NetDriver->ClientConnections)
+		{
+			if (Connection && Connection->FindActorChannelRef(Actor))
+			{
+				RecordRPC(Connection, Actor, Function, Parameters, bReliable);
+			}
+		}
+	}
+	else if (UNetConnection* Connection = Actor->GetNetConnection())
+	{
+		RecordRPC(Connection, Actor, Function, Parameters, bReliable);
+	}
+}
+
+void UCowNetStatsSubsystem::RecordRPC(UNetConnection* Connection, AActor* Actor, UFunction* Function, void* Parameters, bool bReliable)
+{
+	//Written the way UNetDriver::ProcessRemoteFunctionForChannel writes them, so strings, arrays and object
+	//references cost what they cost on the wire. An RPC without a channel yet is counted but not sized
+	uint32 PayloadBits = 0;
+	UNetDriver* NetDriver = HookedDriver.Get();
+	UActorChannel* Channel = Connection->FindActorChannelRef(Actor);
+	const TSharedPtr<FRepLayout> RepLayout = NetDriver && Channel ? NetDriver->GetFunctionRepLayout(Function) : TSharedPtr<FRepLayout>();
+	if (RepLayout.IsValid())
+	{
+		FNetBitWriter Writer(Connection->PackageMap, 0);
+		RepLayout->SendPropertiesForRPC(Function, Channel, Writer, Parameters);
+		PayloadBits = (uint32)Writer.GetNumBits();
+	}
+
+	FConnectionStats& Stats = FindOrAddConnection(Connection);
+	FRPCStats& RPCStats = Stats.RPCs.FindOrAdd(Function->GetFName());
+	++RPCStats.Calls;
+	RPCStats.ReliableCalls += bReliable ? 1 : 0;
+	RPCStats.PayloadBits += PayloadBits;
+
+	++FrameCalls;
+	FrameReliableCalls += bReliable ? 1 : 0;
+	FramePayloadBits += PayloadBits;
+
+	if (UE_TRACE_CHANNELEXPR_IS_ENABLED(MooNetChannel))
+	{
+		const FString FunctionName = Function->GetName();
+		UE_TRACE_LOG(MooNet, RPCSent, MooNetChannel)
+			<< RPCSent.Cycle(FPlatformTime::Cycles64())
+			<< RPCSent.ConnectionId(Stats.ConnectionId)
+			<< RPCSent.PayloadBits(PayloadBits)
+			<< RPCSent.bReliable(bReliable)
+			<< RPCSent.FunctionName(*FunctionName, FunctionName.Len());
+	}
+}
+
+UCowNetStatsSubsystem::FConnectionStats& UCowNetStatsSubsystem::FindOrAddConnection(UNetConnection* Connection)
+{
+	FConnectionStats* Stats = Connections.Find(Connection);
+	if (!Stats)
+	{
+		Stats = &Connections.Add(Connection);
+		Stats->ConnectionId = Connection->GetConnectionId();
+		Stats->Address = Connection->LowLevelGetRemoteAddress(true);
+	}
+	return *Stats;
+}
+
+FString UCowNetStatsSubsystem::ExportCsv() const
+{
+	if (Connections.Num() == 0) { return FString(); }
+
+	//One row per RPC per connection, then a summary row per connection
+	FString Csv = TEXT("Connection,Address,RPC,Calls,ReliableCalls,PayloadBytes,PeakReliableBuffer,PeakOutBytesPerSecond\n");
+	for (const TPair<TObjectKey<UNetConnection>, FConnectionStats>& Pair : Connections)
+	{
+		const FConnectionStats& Stats = Pair.Value;
+		uint32 TotalCalls = 0;
+		uint32 TotalReliableCalls = 0;
+		uint64 TotalPayloadBits = 0;
+		for (const TPair<FName, FRPCStats>& RPC : Stats.RPCs)
+		{
+			Csv += FString::Printf(TEXT("%u,%s,%s,%u,%u,%llu,,\n"), Stats.ConnectionId, *Stats.Address, *RPC.Key.ToString(), RPC.Value.Calls, RPC.Value.ReliableCalls, FMath::DivideAndRoundUp(RPC.Value.PayloadBits, (uint64)8));
+			TotalCalls += RPC.Value.Calls;
+			TotalReliableCalls += RPC.Value.ReliableCalls;
+			TotalPayloadBits += RPC.Value.PayloadBits;
+		}
+		Csv += FString::Printf(TEXT("%u,%s,*,%u,%u,%llu,%d,%d\n"), Stats.ConnectionId, *Stats.Address, TotalCalls, TotalReliableCalls, FMath::DivideAndRoundUp(TotalPayloadBits, (uint64)8), Stats.PeakReliableBuffer, Stats.PeakOutBytesPerSecond);
+	}
+
+	const UWorld* World = GetWorld();
+	const FString NetMode = World && World->GetNetMode() == NM_Client ? TEXT("Client") : TEXT("Server");
+	const FString FileName = FPaths::ProfilingDir() / TEXT("MooNet") / FString::Printf(TEXT("RPCStats-%s-%s.csv"), *NetMode, *FDateTime::Now().ToString());
+	if (!FFileHelper::SaveStringToFile(Csv, *FileName))
+	{
+		return FString();
+	}
+
+	UE_LOG(LogTemp, Log, TEXT("Wrote RPC stats to %s"), *FileName);
+	return FileName;
+}
+
+uint64 UCowNetStatsSubsystem::GetTotalCalls() const
+{
+	uint64 TotalCalls = 0;
+	for (const TPair<TObjectKey<UNetConnection>, FConnectionStats>& Pair : Connections)
+	{
+		for (const TPair<FName, FRPCStats>& RPC : Pair.Value.RPCs)
+		{
+			TotalCalls += RPC.Value.Calls;
+		}
+	}
+	return TotalCalls;
+}
+#else
+void UCowNetStatsSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+}
+
+FString UCowNetStatsSubsystem::ExportCsv() const
+{
+	return FString();
+}
+
+uint64 UCowNetStatsSubsystem::GetTotalCalls() const
+{
+	return 0;
+}
+#endif
@@ -0,0 +1,75 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "CowNetStatsSubsystem.generated.h"
+
+class UNetConnection;
+class UNetDriver;
+
+/**
+ * Counts every RPC this machine sends, per function and per connection, along with the size of its serialized
+ * parameters, and samples each connection's
+ * bandwidth and reliable buffer. Counters feed the MooNet stat group and the MooNet trace channel,
+ * and the totals are written to Saved/Profiling/MooNet as CSV when the match world is torn down
+ * or on moo.NetStats.Export. Compiled out of shipping builds.
+ */
+UCLASS()
+class MOOMOOMADNESS_API UCowNetStatsSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	/** Writes the totals gathered so far, returns the file written or an empty string */
+	FString ExportCsv() const;
+
+	/** RPCs sent since the world began play, over every connection */
+	uint64 GetTotalCalls() const;
+
+protected:
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+#if !UE_BUILD_SHIPPING
+	void OnSendRPC(AActor* Actor, UFunction* Function, void* Parameters, FOutParmRec* OutParms, FFrame* Stack, UObject* SubObject, bool& bBlockSendRPC);
+
+	void RecordRPC(UNetConnection* Connection, AActor* Actor, UFunction* Function, void* Parameters, bool bReliable);
+
+	struct FRPCStats
+	{
+		uint32 Calls = 0;
+		uint32 ReliableCalls = 0;
+		//Parameters as they are written to the bunch, bunch and packet headers not included
+		uint64 PayloadBits = 0;
+	};
+
+	struct FConnectionStats
+	{
+		uint32 ConnectionId = 0;
+		FString Address;
+		TMap<FName, FRPCStats> RPCs;
+		//Highest number of unacked reliable bunches on any one channel, out of RELIABLE_BUFFER
+		int32 PeakReliableBuffer = 0;
+		int32 PeakOutBytesPerSecond = 0;
+	};
+
+	FConnectionStats& FindOrAddConnection(UNetConnection* Connection);
+
+	TWeakObjectPtr<UNetDriver> HookedDriver;
+
+	TMap<TObjectKey<UNetConnection>, FConnectionStats> Connections;
+
+	//Reset every tick for the stat group
+	uint32 FrameCalls = 0;
+	uint32 FrameReliableCalls = 0;
+	uint32 FramePayloadBits = 0;
+#endif
+};
@@ -0,0 +1,200 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CowRepMovement.h"
+
+//Velocity is clamped to this in cm/s, well above a headbutt
+static constexpr int32 MaxQuantizedSpeed = 1 << 14;
+
+/** What was last sent to one connection */
+class FCowRepMovementDeltaState : public INetDeltaBaseState
+{
+public:
+	virtual bool IsStateEqual(INetDeltaBaseState* OtherState) override
+	{
+		const FCowRepMovementDeltaState* Other = static_cast<FCowRepMovementDeltaState*>(OtherState);
+		return State.HasSameMovement(Other->State) && State.Sequence == Other->State.Sequence;
+	}
+
+	FCowQuantizedMovement State;
+	uint8 SendsSinceKeyframe = 0;
+};
+
+//Zigzag keeps small negative deltas small once packed
+static FORCEINLINE uint32 ZigZagEncode(int32 Value) { return (uint32)((Value << 1) ^ (Value >> 31)); }
+static FORCEINLINE int32 ZigZagDecode(uint32 Value) { return (int32)(Value >> 1) ^ -(int32)(Value & 1); }
+
+static void SerializePackedInt(FArchive& Ar, int32& Value)
+{
+	uint32 Encoded = Ar.IsSaving() ? ZigZagEncode(Value) : 0;
+	Ar.SerializeIntPacked(Encoded);
+	Value = ZigZagDecode(Encoded);
+}
+
+static void SerializeKeyframe(FArchive& Ar, FCowQuantizedMovement& State, const FIntVector& LocationBits)
+{
+	for (int32 Axis = 0; Axis < 3; ++Axis)
+	{
+		uint32 Location = (uint32)State.Location[Axis];
+		Ar.SerializeBits(&Location, LocationBits[Axis]);
+		State.Location[Axis] = (int32)Location;
+	}
+	for (int32 Axis = 0; Axis < 3; ++Axis)
+	{
+		SerializePackedInt(Ar, State.Velocity[Axis]);
+	}
+	Ar << State.Yaw;
+}
+
+static void SerializeDelta(FArchive& Ar, FCowQuantizedMovement& State, const FCowQuantizedMovement& Base)
+{
+	for (int32 Axis = 0; Axis < 3; ++Axis)
+	{
+		int32 Delta = State.Location[Axis] - Base.Location[Axis];
+		SerializePackedInt(Ar, Delta);
+		State.Location[Axis] = Base.Location[Axis] + Delta;
+	}
+	for (int32 Axis = 0; Axis < 3; ++Axis)
+	{
+		int32 Delta = State.Velocity[Axis] - Base.Velocity[Axis];
+		SerializePackedInt(Ar, Delta);
+		State.Velocity[Axis] = Base.Velocity[Axis] + Delta;
+	}
+	Ar << State.Yaw;
+}
+
+bool FCowRepMovement::NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms)
+{
+	const FIntVector LocationBits = GetLocationBits();
+
+	if (DeltaParms.Writer)
+	{
+		FBitWriter& Writer = *DeltaParms.Writer;
+		FCowQuantizedMovement Current = Quantize();
+
+		const FCowRepMovementDeltaState* OldState = static_cast<FCowRepMovementDeltaState*>(DeltaParms.OldState);
+		if (OldState && OldState->State.HasSameMovement(Current))
+		{
+			//Idle cows cost nothing
+			return false;
+		}
+
+		//Replays have no acks to roll back to, so they always get full states
+		bool bKeyframe = !OldState || OldState->SendsSinceKeyframe + 1 >= KeyframeInterval || DeltaParms.bInternalAck;
+		Current.Sequence = OldState ? OldState->State.Sequence + 1 : 0;
+
+		TSharedPtr<FCowRepMovementDeltaState> NewState = MakeShared<FCowRepMovementDeltaState>();
+		NewState->State = Current;
+		NewState->SendsSinceKeyframe = bKeyframe ? 0 : OldState->SendsSinceKeyframe + 1;
+		*DeltaParms.NewState = NewState;
+
+		Writer.WriteBit(bKeyframe);
+		Writer << Current.Sequence;
+		if (bKeyframe)
+		{
+			SerializeKeyframe(Writer, Current, LocationBits);
+		}
+		else
+		{
+			uint8 BaseSequence = OldState->State.Sequence;
+			Writer << BaseSequence;
+			SerializeDelta(Writer, Current, OldState->State);
+		}
+		return true;
+	}
+
+	if (DeltaParms.Reader)
+	{
+		FBitReader& Reader = *DeltaParms.Reader;
+		FCowQuantizedMovement Received;
+		const bool bKeyframe = !!Reader.ReadBit();
+		Reader << Received.Sequence;
+
+		const FCowQuantizedMovement* Base = nullptr;
+		if (bKeyframe)
+		{
+			SerializeKeyframe(Reader, Received, LocationBits);
+		}
+		else
+		{
+			uint8 BaseSequence = 0;
+			Reader << BaseSequence;
+			Base = FindReceivedState(BaseSequence);
+
+			//The bits still have to be consumed when the base is missing
+			static const FCowQuantizedMovement MissingBase;
+			SerializeDelta(Reader, Received, Base ? *Base : MissingBase);
+		}
+
+		if (Reader.IsError())
+		{
+			return false;
+		}
+
+		bHasValidState = bKeyframe || Base != nullptr;
+		if (bHasValidState)
+		{
+			AddReceivedState(Received);
+			Dequantize(Received);
+		}
+		return true;
+	}
+
+	return false;
+}
+
+FCowQuantizedMovement FCowRepMovement::Quantize() const
+{
+	FCowQuantizedMovement Quantized;
+	const FIntVector LocationBits = GetLocationBits();
+	for (int32 Axis = 0; Axis < 3; ++Axis)
+	{
+		const int32 MaxValue = (1 << LocationBits[Axis]) - 1;
+		Quantized.Location[Axis] = FMath::Clamp(FMath::RoundToInt((Location[Axis] - Bounds.Min[Axis])/LocationPrecision), 0, MaxValue);
+		Quantized.Velocity[Axis] = FMath::Clamp(FMath::RoundToInt(Velocity[Axis]), -MaxQuantizedSpeed, MaxQuantizedSpeed);
+	}
+	Quantized.Yaw = FRotator::CompressAxisToByte(Yaw);
+	return Quantized;
+}
+
+void FCowRepMovement::Dequantize(const FCowQuantizedMovement& Quantized)
+{
+	for (int32 Axis = 0; Axis < 3; ++Axis)
+	{
+		Location[Axis] = Bounds.Min[Axis] + Quantized.Location[Axis]*LocationPrecision;
+		Velocity[Axis] = Quantized.Velocity[Axis];
+	}
+	Yaw = FRotator::DecompressAxisFromByte(Quantized.Yaw);
+}
+
+FIntVector FCowRepMovement::GetLocationBits() const
+{
+	const FVector Size = Bounds.GetSize();
+	FIntVector Bits;
+	for (int32 Axis = 0; Axis < 3; ++Axis)
+	{
+		const uint32 Steps = (uint32)FMath::CeilToInt(Size[Axis]/LocationPrecision) + 1;
+		Bits[Axis] = FMath::Clamp((int32)FMath::CeilLogTwo(Steps), 1, 30);
+	}
+	return Bits;
+}
+
+const FCowQuantizedMovement* FCowRepMovement::FindReceivedState(uint8 Sequence) const
+{
+	for (int32 i = 0; i < ReceivedNum; ++i)
+	{
+		const FCowQuantizedMovement& State = ReceivedHistory[(ReceivedHead - i + HistorySize) % HistorySize];
+		if (State.Sequence == Sequence)
+		{
+			return &State;
+		}
+	}
+	return nullptr;
+}
+
+void FCowRepMovement::AddReceivedState(const FCowQuantizedMovement& Quantized)
+{
+	ReceivedHead = (ReceivedHead + 1) % HistorySize;
+	ReceivedNum = FMath::Min(ReceivedNum + 1, HistorySize);
+	ReceivedHistory[ReceivedHead] = Quantized;
+}
@@ -0,0 +1,85 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/NetSerialization.h"
+#include "CowRepMovement.generated.h"
+
+namespace UE::Net { struct FCowRepMovementNetSerializer; }
+
+/** A cow's movement after quantization, what actually goes over the wire */
+struct FCowQuantizedMovement
+{
+	//Offset from the arena minimum in LocationPrecision steps
+	FIntVector Location = FIntVector::ZeroValue;
+	//Whole cm/s
+	FIntVector Velocity = FIntVector::ZeroValue;
+	uint8 Yaw = 0;
+	//Which send this is, delta updates name the sequence they are relative to
+	uint8 Sequence = 0;
+
+	FORCEINLINE bool HasSameMovement(const FCowQuantizedMovement& Other) const
+	{
+		return Location == Other.Location && Velocity == Other.Velocity && Yaw == Other.Yaw;
+	}
+};
+
+/**
+ * Replacement for FRepMovement on cows. Location is quantized inside the arena bounds, rotation is yaw
+ * only in a byte, and most updates are written as small deltas against the last state the connection
+ * acknowledged. The engine rolls the per connection base state back when a packet is lost, clients keep
+ * a few recent states to decode against, and every KeyframeInterval sends is a full state.
+ * Iris uses FCowRepMovementNetSerializer instead.
+ */
+USTRUCT()
+struct MOOMOOMADNESS_API FCowRepMovement
+{
+	GENERATED_BODY()
+
+	//Full sends are forced at least this often so a client that lost its base recovers
+	static constexpr uint8 KeyframeInterval = 30;
+
+	//States clients remember to decode deltas against
+	static constexpr int32 HistorySize = 8;
+
+	FVector Location = FVector::ZeroVector;
+	FVector Velocity = FVector::ZeroVector;
+	float Yaw = 0.f;
+
+	//Quantization space, has to match on the server and clients
+	FBox Bounds = FBox(FVector(-50000.f, -50000.f, -5000.f), FVector(50000.f, 50000.f, 20000.f));
+	float LocationPrecision = 1.f;
+
+	/** False when the last update was a delta against a state this client never got, Location etc. are then stale */
+	FORCEINLINE bool HasValidState() const { return bHasValidState; }
+
+	bool NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms);
+
+	FCowQuantizedMovement Quantize() const;
+	void Dequantize(const FCowQuantizedMovement& Quantized);
+
+	/** Bits used for each location axis, from the bounds and precision */
+	FIntVector GetLocationBits() const;
+
+private:
+	friend struct UE::Net::FCowRepMovementNetSerializer;
+
+	const FCowQuantizedMovement* FindReceivedState(uint8 Sequence) const;
+	void AddReceivedState(const FCowQuantizedMovement& Quantized);
+
+	TStaticArray<FCowQuantizedMovement, HistorySize> ReceivedHistory;
+	int32 ReceivedHead = INDEX_NONE;
+	int32 ReceivedNum = 0;
+
+	bool bHasValidState = false;
+};
+
+template<>
+struct TStructOpsTypeTraits<FCowRepMovement> : public TStructOpsTypeTraitsBase2<FCowRepMovement>
+{
+	enum
+	{
+		WithNetDeltaSerializer = true,
+	};
+};
@@ -0,0 +1,212 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CowRepMovementNetSerializer.h"
+
+#if UE_WITH_IRIS
+#include "CowRepMovement.h"
+#include "Iris/Serialization/NetBitStreamReader.h"
+#include "Iris/Serialization/NetBitStreamWriter.h"
+#include "Iris/Serialization/NetSerializerDelegates.h"
+#include "Iris/ReplicationState/PropertyNetSerializerInfoRegistry.h"
+
+namespace UE::Net
+{
+
+struct FCowRepMovementNetSerializer
+{
+	static constexpr uint32 Version = 0;
+
+	struct FQuantizedType
+	{
+		int32 Location[3];
+		int32 Velocity[3];
+		uint8 Yaw;
+	};
+
+	typedef FCowRepMovement SourceType;
+	typedef FQuantizedType QuantizedType;
+	typedef FCowRepMovementNetSerializerConfig ConfigType;
+
+	static const ConfigType DefaultConfig;
+
+	static void Serialize(FNetSerializationContext& Context, const FNetSerializeArgs& Args);
+	static void Deserialize(FNetSerializationContext& Context, const FNetDeserializeArgs& Args);
+	static void SerializeDelta(FNetSerializationContext& Context, const FNetSerializeDeltaArgs& Args);
+	static void DeserializeDelta(FNetSerializationContext& Context, const FNetDeserializeDeltaArgs& Args);
+	static void Quantize(FNetSerializationContext& Context, const FNetQuantizeArgs& Args);
+	static void Dequantize(FNetSerializationContext& Context, const FNetDequantizeArgs& Args);
+	static bool IsEqual(FNetSerializationContext& Context, const FNetIsEqualArgs& Args);
+	static bool Validate(FNetSerializationContext& Context, const FNetValidateArgs& Args);
+
+private:
+	class FNetSerializerRegistryDelegates final : private UE::Net::FNetSerializerRegistryDelegates
+	{
+	public:
+		virtual ~FNetSerializerRegistryDelegates();
+
+	private:
+		virtual void OnPreFreezeNetSerializerRegistry() override;
+	};
+
+	static FCowRepMovementNetSerializer::FNetSerializerRegistryDelegates NetSerializerRegistryDelegates;
+};
+
+UE_NET_IMPLEMENT_SERIALIZER(FCowRepMovementNetSerializer);
+
+const FCowRepMovementNetSerializer::ConfigType FCowRepMovementNetSerializer::DefaultConfig;
+FCowRepMovementNetSerializer::FNetSerializerRegistryDelegates FCowRepMovementNetSerializer::NetSerializerRegistryDelegates;
+
+//Zigzag plus a 5 bit length, a few bits for a cow that barely moved
+static void WritePackedInt(FNetBitStreamWriter& Writer, int32 Value)
+{
+	const uint32 Encoded = (uint32)((Value << 1) ^ (Value >> 31));
+	const uint32 NumBits = Encoded ? FMath::Min(FMath::FloorLog2(Encoded) + 1, 31u) : 0;
+	Writer.WriteBits(NumBits, 5);
+	if (NumBits)
+	{
+		Writer.WriteBits(Encoded, NumBits);
+	}
+}
+
+static int32 ReadPackedInt(FNetBitStreamReader& Reader)
+{
+	const uint32 NumBits = Reader.ReadBits(5);
+	const uint32 Encoded = NumBits ? Reader.ReadBits(NumBits) : 0;
+	return (int32)(Encoded >> 1) ^ -(int32)(Encoded & 1);
+}
+
+void FCowRepMovementNetSerializer::Serialize(FNetSerializationContext& Context, const FNetSerializeArgs& Args)
+{
+	const QuantizedType& Value = *reinterpret_cast<const QuantizedType*>(Args.Source);
+	FNetBitStreamWriter& Writer = *Context.GetBitStreamWriter();
+	for (int32 Axis = 0; Axis < 3; ++Axis)
+	{
+		WritePackedInt(Writer, Value.Location[Axis]);
+	}
+	for (int32 Axis = 0; Axis < 3; ++Axis)
+	{
+		WritePackedInt(Writer, Value.Velocity[Axis]);
+	}
+	Writer.WriteBits(Value.Yaw, 8);
+}
+
+void FCowRepMovementNetSerializer::Deserialize(FNetSerializationContext& Context, const FNetDeserializeArgs& Args)
+{
+	QuantizedType& Value = *reinterpret_cast<QuantizedType*>(Args.Target);
+	FNetBitStreamReader& Reader = *Context.GetBitStreamReader();
+	for (int32 Axis = 0; Axis < 3; ++Axis)
+	{
+		Value.Location[Axis] = ReadPackedInt(Reader);
+	}
+	for (int32 Axis = 0; Axis < 3; ++Axis)
+	{
+		Value.Velocity[Axis] = ReadPackedInt(Reader);
+	}
+	Value.Yaw = (uint8)Reader.ReadBits(8);
+}
+
+void FCowRepMovementNetSerializer::SerializeDelta(FNetSerializationContext& Context, const FNetSerializeDeltaArgs& Args)
+{
+	const QuantizedType& Value = *reinterpret_cast<const QuantizedType*>(Args.Source);
+	const QuantizedType& Prev = *reinterpret_cast<const QuantizedType*>(Args.Prev);
+	FNetBitStreamWriter& Writer = *Context.GetBitStreamWriter();
+	for (int32 Axis = 0; Axis < 3; ++Axis)
+	{
+		WritePackedInt(Writer, Value.Location[Axis] - Prev.Location[Axis]);
+	}
+	for (int32 Axis = 0; Axis < 3; ++Axis)
+	{
+		WritePackedInt(Writer, Value.Velocity[Axis] - Prev.Velocity[Axis]);
+	}
+	Writer.WriteBits(Value.Yaw, 8);
+}
+
+void FCowRepMovementNetSerializer::DeserializeDelta(FNetSerializationContext& Context, const FNetDeserializeDeltaArgs& Args)
+{
+	QuantizedType& Value = *reinterpret_cast<QuantizedType*>(Args.Target);
+	const QuantizedType& Prev = *reinterpret_cast<const QuantizedType*>(Args.Prev);
+	FNetBitStreamReader& Reader = *Context.GetBitStreamReader();
+	for (int32 Axis = 0; Axis < 3; ++Axis)
+	{
+		Value.Location[Axis] = Prev.Location[Axis] + ReadPackedInt(Reader);
+	}
+	for (int32 Axis = 0; Axis < 3; ++Axis)
+	{
+		Value.Velocity[Axis] = Prev.Velocity[Axis] + ReadPackedInt(Reader);
+	}
+	Value.Yaw = (uint8)Reader.ReadBits(8);
+}
+
+void FCowRepMovementNetSerializer::Quantize(FNetSerializationContext& Context, const FNetQuantizeArgs& Args)
+{
+	//Same bounds, precision and clamps as the legacy path so both replication systems put a cow in the same place
+	const SourceType& Source = *reinterpret_cast<const SourceType*>(Args.Source);
+	QuantizedType& Target = *reinterpret_cast<QuantizedType*>(Args.Target);
+	const FCowQuantizedMovement Quantized = Source.Quantize();
+	for (int32 Axis = 0; Axis < 3; ++Axis)
+	{
+		Target.Location[Axis] = Quantized.Location[Axis];
+		Target.Velocity[Axis] = Quantized.Velocity[Axis];
+	}
+	Target.Yaw = Quantized.Yaw;
+}
+
+void FCowRepMovementNetSerializer::Dequantize(FNetSerializationContext& Context, const FNetDequantizeArgs& Args)
+{
+	const QuantizedType& Source = *reinterpret_cast<const QuantizedType*>(Args.Source);
+	SourceType& Target = *reinterpret_cast<SourceType*>(Args.Target);
+	FCowQuantizedMovement Quantized;
+	for (int32 Axis = 0; Axis < 3; ++Axis)
+	{
+		Quantized.Location[Axis] = Source.Location[Axis];
+		Quantized.Velocity[Axis] = Source.Velocity[Axis];
+	}
+	Quantized.Yaw = Source.Yaw;
+	Target.Dequantize(Quantized);
+	//Iris never hands out a delta it can't resolve
+	Target.bHasValidState = true;
+}
+
+bool FCowRepMovementNetSerializer::IsEqual(FNetSerializationContext& Context, const FNetIsEqualArgs& Args)
+{
+	if (Args.bStateIsQuantized)
+	{
+		const QuantizedType& Value0 = *reinterpret_cast<const QuantizedType*>(Args.Source0);
+		const QuantizedType& Value1 = *reinterpret_cast<const QuantizedType*>(Args.Source1);
+		for (int32 Axis = 0; Axis < 3; ++Axis)
+		{
+			if (Value0.Location[Axis] != Value1.Location[Axis] || Value0.Velocity[Axis] != Value1.Velocity[Axis])
+			{
+				return false;
+			}
+		}
+		return Value0.Yaw == Value1.Yaw;
+	}
+
+	const SourceType& Source0 = *reinterpret_cast<const SourceType*>(Args.Source0);
+	const SourceType& Source1 = *reinterpret_cast<const SourceType*>(Args.Source1);
+	return Source0.Location == Source1.Location && Source0.Velocity == Source1.Velocity && Source0.Yaw == Source1.Yaw;
+}
+
+bool FCowRepMovementNetSerializer::Validate(FNetSerializationContext& Context, const FNetValidateArgs& Args)
+{
+	const SourceType& Source = *reinterpret_cast<const SourceType*>(Args.Source);
+	return !Source.Location.ContainsNaN() && !Source.Velocity.ContainsNaN();
+}
+
+static const FName PropertyNetSerializerRegistry_NAME_CowRepMovement("CowRepMovement");
+UE_NET_IMPLEMENT_NAMED_STRUCT_NETSERIALIZER_INFO(PropertyNetSerializerRegistry_NAME_CowRepMovement, FCowRepMovementNetSerializer);
+
+FCowRepMovementNetSerializer::FNetSerializerRegistryDelegates::~FNetSerializerRegistryDelegates()
+{
+	UE_NET_UNREGISTER_NETSERIALIZER_INFO(PropertyNetSerializerRegistry_NAME_CowRepMovement);
+}
+
+void FCowRepMovementNetSerializer::FNetSerializerRegistryDelegates::OnPreFreezeNetSerializerRegistry()
+{
+	UE_NET_REGISTER_NETSERIALIZER_INFO(PropertyNetSerializerRegistry_NAME_CowRepMovement);
+}
+
+}
+#endif
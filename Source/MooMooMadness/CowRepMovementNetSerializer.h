@@ -0,0 +1,26 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#if UE_WITH_IRIS
+#include "Iris/Serialization/NetSerializer.h"
+
+//Not a USTRUCT, UHT won't reflect types inside UE_WITH_IRIS and the serializer has nothing to configure
+struct FCowRepMovementNetSerializerConfig : public FNetSerializerConfig
+{
+};
+
+namespace UE::Net
+{
+
+/**
+ * Iris serializer for FCowRepMovement, which legacy replication sends through NetDeltaSerialize.
+ * Iris keeps its own acked baselines, so this reuses the legacy quantization (arena bounds,
+ * LocationPrecision, whole cm/s and a yaw byte) and writes small deltas against whatever baseline Iris hands it.
+ */
+UE_NET_DECLARE_SERIALIZER(FCowRepMovementNetSerializer, MOOMOOMADNESS_API);
+
+}
+#endif
@@ -0,0 +1,188 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CowSignificanceSubsystem.h"
+
+#include "Destroyable.h"
+#include "MooMooMadnessCharacter.h"
+#include "Camera/PlayerCameraManager.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "IAnimationBudgetAllocator.h"
+
+UCowSignificanceSubsystem::UCowSignificanceSubsystem()
+{
+	Levels.SetNum((uint8)ECowSignificance::MAX);
+
+	FCowSignificanceSettings& Lowest = Levels[(uint8)ECowSignificance::Lowest];
+	Lowest.AnimSignificance = 0.1f;
+	Lowest.bCastShadows = false;
+	Lowest.bClientHitBoxCollision = false;
+	Lowest.AudioPriority = 0.25f;
+
+	FCowSignificanceSettings& Low = Levels[(uint8)ECowSignificance::Low];
+	Low.MinScreenSize = 0.02f;
+	Low.AnimSignificance = 0.35f;
+	Low.bCastShadows = false;
+	Low.bClientHitBoxCollision = false;
+	Low.AudioPriority = 0.5f;
+
+	FCowSignificanceSettings& Medium = Levels[(uint8)ECowSignificance::Medium];
+	Medium.MinScreenSize = 0.06f;
+	Medium.AnimSignificance = 0.7f;
+	Medium.AudioPriority = 0.75f;
+
+	Levels[(uint8)ECowSignificance::High].MinScreenSize = 0.15f;
+}
+
+bool UCowSignificanceSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	return !IsRunningDedicatedServer() && Super::ShouldCreateSubsystem(Outer);
+}
+
+bool UCowSignificanceSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UCowSignificanceSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	//Only clients throttle animation, the server sweeps attacks against the bones
+	if (InWorld.GetNetMode() != NM_DedicatedServer)
+	{
+		if (IAnimationBudgetAllocator* Budget = IAnimationBudgetAllocator::Get(&InWorld))
+		{
+			Budget->SetEnabled(true);
+		}
+	}
+}
+
+void UCowSignificanceSubsystem::Register(AActor* Actor)
+{
+	//PIE dedicated servers share the process with clients
+	if (!Actor || EntryIndices.Contains(Actor) || GetWorld()->GetNetMode() == NM_DedicatedServer)
+	{
+		return;
+	}
+
+	EntryIndices.Add(Actor, Entries.Num());
+	Entries.Add({ Actor, ECowSignificance::High });
+
+	//Later ticks only apply changes, so the starting level has to be applied here
+	Apply(Actor, ECowSignificance::High);
+}
+
+void UCowSignificanceSubsystem::Unregister(AActor* Actor)
+{
+	int32 Index;
+	if (!EntryIndices.RemoveAndCopyValue(Actor, Index))
+	{
+		return;
+	}
+
+	Entries.RemoveAtSwap(Index, 1, false);
+	if (Entries.IsValidIndex(Index))
+	{
+		EntryIndices.Add(Entries[Index].Actor.Get(), Index);
+	}
+}
+
+ECowSignificance UCowSignificanceSubsystem::GetSignificance(const AActor* Actor) const
+{
+	const int32* Index = EntryIndices.Find(Actor);
+	return Index ? Entries[*Index].Significance : ECowSignificance::High;
+}
+
+const FCowSignificanceSettings& UCowSignificanceSubsystem::GetSettings(ECowSignificance Significance) const
+{
+	static const FCowSignificanceSettings FullSettings;
+	return Levels.IsValidIndex((uint8)Significance) ? Levels[(uint8)Significance] : FullSettings;
+}
+
+TStatId UCowSignificanceSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UCowSignificanceSubsystem, STATGROUP_Tickables);
+}
+
+void UCowSignificanceSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	const APlayerController* PlayerController = GetWorld()->GetFirstPlayerController();
+	const APlayerCameraManager* CameraManager = PlayerController ? PlayerController->PlayerCameraManager.Get() : nullptr;
+	if (!CameraManager || Entries.IsEmpty())
+	{
+		return;
+	}
+
+	//Screen size of a bounds radius at distance D is Radius*ScreenScale/D
+	const FVector ViewLocation = CameraManager->GetCameraLocation();
+	const float ScreenScale = 1.f/FMath::Max(FMath::Tan(FMath::DegreesToRadians(CameraManager->GetFOVAngle()*0.5f)), KINDA_SMALL_NUMBER);
+
+	const int32 NumEvaluations = FMath::Min(Entries.Num(), FMath::Max(MaxEvaluationsPerTick, 1));
+	for (int32 Evaluation = 0; Evaluation < NumEvaluations; Evaluation++)
+	{
+		NextEntry = NextEntry < Entries.Num() ? NextEntry : 0;
+		FEntry& Entry = Entries[NextEntry++];
+
+		AActor* Actor = Entry.Actor.Get();
+		if (!Actor)
+		{
+			continue;
+		}
+
+		const ECowSignificance Significance = Evaluate(Actor, ViewLocation, ScreenScale);
+		if (Significance != Entry.Significance)
+		{
+			Entry.Significance = Significance;
+			Apply(Actor, Significance);
+		}
+	}
+}
+
+ECowSignificance UCowSignificanceSubsystem::Evaluate(const AActor* Actor, const FVector& ViewLocation, float ScreenScale) const
+{
+	//The player's own cow always gets the full treatment
+	const APawn* Pawn = Cast<APawn>(Actor);
+	if (Pawn && Pawn->IsLocallyControlled())
+	{
+		return ECowSignificance::High;
+	}
+
+	const USceneComponent* Root = Actor->GetRootComponent();
+	if (!Root)
+	{
+		return ECowSignificance::Lowest;
+	}
+
+	const float Distance = FVector::Dist(Root->Bounds.Origin, ViewLocation);
+	if (Distance > MaxDistance)
+	{
+		return ECowSignificance::Lowest;
+	}
+
+	const float ScreenSize = Distance > Root->Bounds.SphereRadius ? Root->Bounds.SphereRadius*ScreenScale/Distance : 1.f;
+	for (int32 Level = (uint8)ECowSignificance::High; Level > (uint8)ECowSignificance::Lowest; Level--)
+	{
+		if (ScreenSize >= GetSettings((ECowSignificance)Level).MinScreenSize)
+		{
+			return (ECowSignificance)Level;
+		}
+	}
+	return ECowSignificance::Lowest;
+}
+
+void UCowSignificanceSubsystem::Apply(AActor* Actor, ECowSignificance Significance) const
+{
+	const FCowSignificanceSettings& Settings = GetSettings(Significance);
+	if (AMooMooMadnessCharacter* Cow = Cast<AMooMooMadnessCharacter>(Actor))
+	{
+		Cow->ApplySignificance(Settings);
+	}
+	else if (ADestroyable* Destroyable = Cast<ADestroyable>(Actor))
+	{
+		Destroyable->ApplySignificance(Settings);
+	}
+}
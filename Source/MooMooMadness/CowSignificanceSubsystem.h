@@ -0,0 +1,110 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "CowSignificanceSubsystem.generated.h"
+
+/** How much an object matters to the local camera, from least to most */
+UENUM()
+enum class ECowSignificance : uint8
+{
+	Lowest,
+	Low,
+	Medium,
+	High,
+
+	MAX UMETA(Hidden)
+};
+
+/** What an object is allowed to cost at one significance level */
+USTRUCT()
+struct FCowSignificanceSettings
+{
+	GENERATED_BODY()
+
+	//Smallest screen size, as a fraction of the view height, that still reaches this level
+	UPROPERTY(config)
+	float MinScreenSize = 0.f;
+
+	//Significance handed to the animation budget allocator, 0 to 1. Lower is ticked less often and interpolated once over budget
+	UPROPERTY(config)
+	float AnimSignificance = 1.f;
+
+	UPROPERTY(config)
+	bool bCastShadows = true;
+
+	//Whether destroyable hit boxes keep their collision on clients, the server always keeps it
+	UPROPERTY(config)
+	bool bClientHitBoxCollision = true;
+
+	//Audio component priority, higher is kept longer when voices run out
+	UPROPERTY(config)
+	float AudioPriority = 1.f;
+};
+
+/**
+ * Scores cows and destroyables by their screen size from the local camera and sorts them into significance levels,
+ * letting each object scale its animation, shadows, collision and audio to its level. Cow animation goes through the
+ * animation budget allocator, which is enabled here and whose per-platform budget comes from the device profiles.
+ * Objects are re-evaluated round robin, at most MaxEvaluationsPerTick per frame, and only told when their level changes.
+ * Client side only, dedicated servers never create it.
+ */
+UCLASS(config=Game)
+class MOOMOOMADNESS_API UCowSignificanceSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	UCowSignificanceSubsystem();
+
+	/** Starts scoring an actor. It has to be a cow or a destroyable */
+	void Register(AActor* Actor);
+
+	void Unregister(AActor* Actor);
+
+	/** Current level of a registered actor, High for anything that isn't registered */
+	ECowSignificance GetSignificance(const AActor* Actor) const;
+
+	/** What objects at a level are allowed to cost, levels missing from config get everything */
+	const FCowSignificanceSettings& GetSettings(ECowSignificance Significance) const;
+
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+protected:
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+
+	//Indexed by ECowSignificance, from Lowest to High
+	UPROPERTY(config)
+	TArray<FCowSignificanceSettings> Levels;
+
+	//Anything further than this from the camera is Lowest whatever its size
+	UPROPERTY(config)
+	float MaxDistance = 12000.f;
+
+	//Time slicing budget, the full list is covered every Num / MaxEvaluationsPerTick frames
+	UPROPERTY(config)
+	int32 MaxEvaluationsPerTick = 64;
+
+private:
+	ECowSignificance Evaluate(const AActor* Actor, const FVector& ViewLocation, float ScreenScale) const;
+
+	void Apply(AActor* Actor, ECowSignificance Significance) const;
+
+	struct FEntry
+	{
+		TWeakObjectPtr<AActor> Actor;
+		ECowSignificance Significance = ECowSignificance::High;
+	};
+	TArray<FEntry> Entries;
+
+	//Index into Entries of every registered actor
+	TMap<TObjectKey<AActor>, int32> EntryIndices;
+
+	//Where the next tick's evaluations start
+	int32 NextEntry = 0;
+};
@@ -0,0 +1,118 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CowSpatialHash.h"
+
+FCowSpatialHash::FCowSpatialHash(float InCellSize)
+	: CellSize(FMath::Max(InCellSize, 1.f))
+{
+}
+
+int32 FCowSpatialHash::Add(AActor* Actor, ECowBroadphaseType Type, const FBox& Bounds)
+{
+	const int32 Handle = FreeEntries.Num() > 0 ? FreeEntries.Pop(false) : Entries.AddDefaulted();
+
+	FEntry& Entry = Entries[Handle];
+	Entry.Actor = Actor;
+	Entry.Type = Type;
+	Entry.Bounds = Bounds;
+	Entry.MinCell = GetCell(Bounds.Min);
+	Entry.MaxCell = GetCell(Bounds.Max);
+	LinkCells(Handle);
+	return Handle;
+}
+
+void FCowSpatialHash::Update(int32 Handle, const FBox& Bounds)
+{
+	FEntry& Entry = Entries[Handle];
+	Entry.Bounds = Bounds;
+
+	const FIntPoint MinCell = GetCell(Bounds.Min);
+	const FIntPoint MaxCell = GetCell(Bounds.Max);
+	if (MinCell == Entry.MinCell && MaxCell == Entry.MaxCell)
+	{
+		return;
+	}
+
+	UnlinkCells(Handle);
+	Entry.MinCell = MinCell;
+	Entry.MaxCell = MaxCell;
+	LinkCells(Handle);
+}
+
+void FCowSpatialHash::Remove(int32 Handle)
+{
+	UnlinkCells(Handle);
+	Entries[Handle] = FEntry();
+	FreeEntries.Add(Handle);
+}
+
+FIntPoint FCowSpatialHash::GetCell(const FVector& Location) const
+{
+	return FIntPoint(FMath::FloorToInt(Location.X / CellSize), FMath::FloorToInt(Location.Y / CellSize));
+}
+
+void FCowSpatialHash::LinkCells(int32 Handle)
+{
+	const FEntry& Entry = Entries[Handle];
+	for (int32 X = Entry.MinCell.X; X <= Entry.MaxCell.X; ++X)
+	{
+		for (int32 Y = Entry.MinCell.Y; Y <= Entry.MaxCell.Y; ++Y)
+		{
+			Cells.FindOrAdd(FIntPoint(X, Y)).Add(Handle);
+		}
+	}
+}
+
+void FCowSpatialHash::UnlinkCells(int32 Handle)
+{
+	const FEntry& Entry = Entries[Handle];
+	for (int32 X = Entry.MinCell.X; X <= Entry.MaxCell.X; ++X)
+	{
+		for (int32 Y = Entry.MinCell.Y; Y <= Entry.MaxCell.Y; ++Y)
+		{
+			const FIntPoint Cell(X, Y);
+			if (TArray<int32>* CellEntries = Cells.Find(Cell))
+			{
+				CellEntries->RemoveSingleSwap(Handle, false);
+				if (CellEntries->Num() == 0)
+				{
+					Cells.Remove(Cell);
+				}
+			}
+		}
+	}
+}
+
+void FCowSpatialHash::ForEachOverlapping(const FBox& Box, ECowBroadphaseType TypeMask, TFunctionRef<void(AActor*)> Visitor) const
+{
+	const uint32 Stamp = ++QueryCounter;
+	const FIntPoint MinCell = GetCell(Box.Min);
+	const FIntPoint MaxCell = GetCell(Box.Max);
+	for (int32 X = MinCell.X; X <= MaxCell.X; ++X)
+	{
+		for (int32 Y = MinCell.Y; Y <= MaxCell.Y; ++Y)
+		{
+			const TArray<int32>* CellEntries = Cells.Find(FIntPoint(X, Y));
+			if (!CellEntries) { continue; }
+
+			for (const int32 Handle : *CellEntries)
+			{
+				const FEntry& Entry = Entries[Handle];
+				if (Entry.QueryStamp == Stamp || !EnumHasAnyFlags(Entry.Type, TypeMask))
+				{
+					continue;
+				}
+				Entry.QueryStamp = Stamp;
+
+				if (Entry.Bounds.Intersect(Box))
+				{
+					if (AActor* Actor = Entry.Actor.Get())
+					{
+						Visitor(Actor);
+					}
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,65 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/** What kind of actor a spatial hash entry is, usable as a query mask */
+enum class ECowBroadphaseType : uint8
+{
+	None = 0,
+	Cow = 1 << 0,
+	Destroyable = 1 << 1,
+	All = Cow | Destroyable
+};
+ENUM_CLASS_FLAGS(ECowBroadphaseType);
+
+/**
+ * Uniform 2D grid over the arena floor. Each entry is stored in every cell its bounds overlap,
+ * and moving an entry only touches the cell lists when it crosses into a different range of cells.
+ */
+class MOOMOOMADNESS_API FCowSpatialHash
+{
+public:
+	explicit FCowSpatialHash(float InCellSize = 500.f);
+
+	/** Adds an actor with the given bounds, returns a handle for Update and Remove */
+	int32 Add(AActor* Actor, ECowBroadphaseType Type, const FBox& Bounds);
+
+	/** Moves an entry to new bounds */
+	void Update(int32 Handle, const FBox& Bounds);
+
+	void Remove(int32 Handle);
+
+	/** Appends every live actor matching TypeMask whose bounds overlap Box */
+	template<typename AllocatorType>
+	void Query(const FBox& Box, ECowBroadphaseType TypeMask, TArray<AActor*, AllocatorType>& OutActors) const
+	{
+		ForEachOverlapping(Box, TypeMask, [&OutActors](AActor* Actor) { OutActors.Add(Actor); });
+	}
+
+	int32 Num() const { return Entries.Num() - FreeEntries.Num(); }
+
+private:
+	struct FEntry
+	{
+		TWeakObjectPtr<AActor> Actor;
+		FBox Bounds = FBox(ForceInit);
+		FIntPoint MinCell = FIntPoint::ZeroValue;
+		FIntPoint MaxCell = FIntPoint::ZeroValue;
+		ECowBroadphaseType Type = ECowBroadphaseType::None;
+		//Last query that visited this entry, so entries spanning several cells are only returned once
+		mutable uint32 QueryStamp = 0;
+	};
+
+	FIntPoint GetCell(const FVector& Location) const;
+	void LinkCells(int32 Handle);
+	void UnlinkCells(int32 Handle);
+	void ForEachOverlapping(const FBox& Box, ECowBroadphaseType TypeMask, TFunctionRef<void(AActor*)> Visitor) const;
+
+	float CellSize;
+	TArray<FEntry> Entries;
+	TArray<int32> FreeEntries;
+	TMap<FIntPoint, TArray<int32>> Cells;
+	mutable uint32 QueryCounter = 0;
+};
@@ -4,9 +4,15 @@
 #include "Destroyable.h"
 
 #include "MooMooMadnessCharacter.h"
+#include "MooMooMadness.h"
+#include "CowBroadphaseSubsystem.h"
+#include "CowDestructionAudioSubsystem.h"
+#include "CowSignificanceSubsystem.h"
+#include "DestroyableSubsystem.h"
 #include "Components/BoxComponent.h"
 #include "DynamicMesh/ColliderMesh.h"
 #include "Kismet/GameplayStatics.h"
+#include "Net/UnrealNetwork.h"
 
 // Sets default values
 ADestroyable::ADestroyable()
@@ -14,6 +20,11 @@ ADestroyable::ADestroyable()
  	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
 	PrimaryActorTick.bCanEverTick = false;
 
+	//Destruction is replicated by ADestroyableManager, props never need a channel of their own
+	bReplicates = true;
+	NetDormancy = DORM_Initial;
+	bDestroyed = false;
+
 	//Setup Mesh and HitBox attachment
 	StaticMesh = CreateDefaultSubobject<UStaticMeshComponent>(TEXT("StaticMesh"));
 	RootComponent = StaticMesh;
@@ -30,8 +41,75 @@ ADestroyable::ADestroyable()
 void ADestroyable::BeginPlay()
 {
 	Super::BeginPlay();
-	
+
+	//Destroyables never move, hash them once
+	if (UCowBroadphaseSubsystem* Broadphase = GetWorld()->GetSubsystem<UCowBroadphaseSubsystem>())
+	{
+		Broadphase->Register(this, ECowBroadphaseType::Destroyable, false);
+	}
+
+	DefaultHitBoxCollision = HitBox->GetCollisionEnabled();
+	if (UCowSignificanceSubsystem* Significance = GetWorld()->GetSubsystem<UCowSignificanceSubsystem>())
+	{
+		Significance->Register(this);
+	}
+
+	UDestroyableSubsystem* Destroyables = GetWorld()->GetSubsystem<UDestroyableSubsystem>();
+	if (IsNetStartupActor())
+	{
+		PropId = UDestroyableSubsystem::MakePlacedActorId(this);
+	}
+	else if (HasAuthority())
+	{
+		//Names of spawned actors differ between the server and clients, so the server hands out the id
+		SET_REPLICATED_PROPERTY(ADestroyable, PropId, Destroyables ? Destroyables->MakeSpawnedPropId() : 0);
+	}
+	else
+	{
+		ensureMsgf(PropId != 0, TEXT("%s was spawned without a prop id from the server"), *GetName());
+	}
+
+	if (Destroyables)
+	{
+		Destroyables->Register(this);
+	}
+}
+
+void ADestroyable::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	//Placed props never send it, their id comes from their path on both sides
+	FDoRepLifetimeParams Params;
+	Params.bIsPushBased = true;
+	Params.Condition = COND_InitialOnly;
+	DOREPLIFETIME_WITH_PARAMS_FAST(ADestroyable, PropId, Params);
+}
+
+void ADestroyable::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UCowBroadphaseSubsystem* Broadphase = GetWorld()->GetSubsystem<UCowBroadphaseSubsystem>())
+	{
+		Broadphase->Unregister(this);
+	}
+	if (UDestroyableSubsystem* Destroyables = GetWorld()->GetSubsystem<UDestroyableSubsystem>())
+	{
+		Destroyables->Unregister(this);
+	}
+	if (UCowSignificanceSubsystem* Significance = GetWorld()->GetSubsystem<UCowSignificanceSubsystem>())
+	{
+		Significance->Unregister(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+#if WITH_EDITOR
+bool ADestroyable::IsHLODRelevant() const
+{
+	return false;
 }
+#endif
 
 // Called every frame
 void ADestroyable::Tick(float DeltaTime)
@@ -53,30 +131,61 @@ void ADestroyable::Tick(float DeltaTime)
 	}
 }*/
 
-void ADestroyable::DestroySelf()
+bool ADestroyable::DestroySelf()
 {
-	Server_DestroySelf();
-}
+	if (!HasAuthority() || bDestroyed) { return false; }
 
-bool ADestroyable::Server_DestroySelf_Validate()
-{
-	return true;
+	UDestroyableSubsystem* Destroyables = GetWorld()->GetSubsystem<UDestroyableSubsystem>();
+	return Destroyables && Destroyables->DestroyProp(this);
 }
 
-void ADestroyable::Server_DestroySelf_Implementation()
+void ADestroyable::SetDestroyed(bool bNewDestroyed, bool bPlayEffects)
 {
-	Multi_DestroySelf();
-}
+	if (bDestroyed == bNewDestroyed) { return; }
+	bDestroyed = bNewDestroyed;
 
-bool ADestroyable::Multi_DestroySelf_Validate()
-{
-	return true;
+	//Props stay loaded and dormant, destroying them would cost every connection a reliable bunch
+	SetActorHiddenInGame(bDestroyed);
+	SetActorEnableCollision(!bDestroyed);
+
+	if (UCowBroadphaseSubsystem* Broadphase = GetWorld()->GetSubsystem<UCowBroadphaseSubsystem>())
+	{
+		if (bDestroyed)
+		{
+			Broadphase->Unregister(this);
+		}
+		else
+		{
+			Broadphase->Register(this, ECowBroadphaseType::Destroyable, false);
+		}
+	}
+
+	if (bDestroyed && bPlayEffects)
+	{
+		//Batched with every other destruction this frame, Blueprints only get the event when there's no sound to pool
+		UCowDestructionAudioSubsystem* DestructionAudio = GetWorld()->GetSubsystem<UCowDestructionAudioSubsystem>();
+		if (DestructionSound && DestructionAudio)
+		{
+			DestructionAudio->QueueDestruction(DestructionSound, GetActorLocation(), AudioPriority);
+		}
+		else
+		{
+			PlaySound();
+		}
+	}
 }
 
-void ADestroyable::Multi_DestroySelf_Implementation()
+void ADestroyable::ApplySignificance(const FCowSignificanceSettings& Settings)
 {
-	PlaySound();
-	Destroy();
+	StaticMesh->SetCastShadow(Settings.bCastShadows);
+
+	//Hits are only ever resolved on the server, clients just need the hit box for props near the camera
+	if (GetNetMode() == NM_Client)
+	{
+		HitBox->SetCollisionEnabled(Settings.bClientHitBoxCollision ? DefaultHitBoxCollision.GetValue() : ECollisionEnabled::NoCollision);
+	}
+
+	AudioPriority = Settings.AudioPriority;
 }
 
 int ADestroyable::GetPointValue()
@@ -6,6 +6,7 @@
 #include "GameFramework/Actor.h"
 #include "Destroyable.generated.h"
 
+struct FCowSignificanceSettings;
 
 UCLASS()
 class MOOMOOMADNESS_API ADestroyable : public AActor
@@ -26,6 +27,11 @@ protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 
+	// Called when the actor is removed from the level
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Score System", meta = (AllowPrivateAccess = "true"))
 	int32 PointValue = 0;
 	
@@ -35,6 +41,19 @@ protected:
 
 	UFUNCTION(BlueprintImplementableEvent)
 	void PlaySound();
+
+private:
+	//Stable across server and clients, see GetPropId. Only replicated for props spawned at runtime
+	UPROPERTY(Replicated)
+	uint32 PropId = 0;
+
+	uint8 bDestroyed : 1;
+
+	//What the HitBox had before significance turned it off on a client
+	TEnumAsByte<ECollisionEnabled::Type> DefaultHitBoxCollision = ECollisionEnabled::QueryAndPhysics;
+
+	//Priority the destruction sound is played at, set by significance
+	float AudioPriority = 1.f;
 	
 	/*UFUNCTION()
 	void BeginOverlap(UPrimitiveComponent* OverlappedComponent, 
@@ -48,17 +67,30 @@ public:
 	// Called every frame
 	virtual void Tick(float DeltaTime) override;
 
-	void DestroySelf();
+#if WITH_EDITOR
+	/**
+	 * Destroyables are kept out of HLOD, proxies are baked and would keep drawing a prop after it was destroyed.
+	 * Only static scenery belongs in HLOD layers, props are drawn when their cell streams in
+	 */
+	virtual bool IsHLODRelevant() const override;
+#endif
 
-	UFUNCTION (Server, Reliable, WithValidation)
-	void Server_DestroySelf();
-	bool Server_DestroySelf_Validate();
-	void Server_DestroySelf_Implementation();
-	
-	UFUNCTION (NetMulticast, Reliable, WithValidation)
-	void Multi_DestroySelf();
-	bool Multi_DestroySelf_Validate();
-	void Multi_DestroySelf_Implementation();
+	/** Destroys the prop for everyone. Server only, returns false if it was already destroyed */
+	bool DestroySelf();
+
+	/** Hides or shows the prop locally, called by UDestroyableSubsystem as destruction state replicates */
+	void SetDestroyed(bool bNewDestroyed, bool bPlayEffects);
+
+	FORCEINLINE bool IsDestroyed() const { return bDestroyed; }
+
+	/** Scales shadows, client collision and audio to how much this prop matters to the local camera, called by UCowSignificanceSubsystem */
+	void ApplySignificance(const FCowSignificanceSettings& Settings);
+
+	/**
+	 * Id shared by the server and every client. Placed props build it from their level path, props spawned at runtime
+	 * get one from the server that arrives with their first bunch
+	 */
+	FORCEINLINE uint32 GetPropId() const { return PropId; }
 
 	int GetPointValue();
 
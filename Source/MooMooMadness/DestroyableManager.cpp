@@ -0,0 +1,87 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "DestroyableManager.h"
+
+#include "DestroyableSubsystem.h"
+#include "Net/UnrealNetwork.h"
+
+void FDestroyedProp::PostReplicatedAdd(const FDestroyedPropArray& InArraySerializer)
+{
+	if (InArraySerializer.Owner)
+	{
+		InArraySerializer.Owner->OnPropDestroyed(PropId, InArraySerializer.bReceivedInitialState);
+	}
+}
+
+void FDestroyedProp::PreReplicatedRemove(const FDestroyedPropArray& InArraySerializer)
+{
+	if (InArraySerializer.Owner)
+	{
+		InArraySerializer.Owner->OnPropRestored(PropId);
+	}
+}
+
+ADestroyableManager::ADestroyableManager()
+{
+	bReplicates = true;
+	bAlwaysRelevant = true;
+
+	//Only changes when something is destroyed, MarkDestroyed forces an update when it does
+	NetUpdateFrequency = 2.f;
+}
+
+void ADestroyableManager::PostInitializeComponents()
+{
+	Super::PostInitializeComponents();
+
+	DestroyedProps.Owner = this;
+}
+
+void ADestroyableManager::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME(ADestroyableManager, DestroyedProps);
+}
+
+bool ADestroyableManager::MarkDestroyed(uint32 PropId)
+{
+	for (const FDestroyedProp& Prop : DestroyedProps.Items)
+	{
+		if (Prop.PropId == PropId) { return false; }
+	}
+
+	FDestroyedProp& Prop = DestroyedProps.Items.AddDefaulted_GetRef();
+	Prop.PropId = PropId;
+	DestroyedProps.MarkItemDirty(Prop);
+	ForceNetUpdate();
+	return true;
+}
+
+bool ADestroyableManager::MarkRestored(uint32 PropId)
+{
+	const int32 Index = DestroyedProps.Items.IndexOfByPredicate([PropId](const FDestroyedProp& Prop) { return Prop.PropId == PropId; });
+	if (Index == INDEX_NONE) { return false; }
+
+	DestroyedProps.Items.RemoveAtSwap(Index);
+	DestroyedProps.MarkArrayDirty();
+	ForceNetUpdate();
+	return true;
+}
+
+void ADestroyableManager::OnPropDestroyed(uint32 PropId, bool bPlayEffects)
+{
+	if (UDestroyableSubsystem* Destroyables = GetWorld()->GetSubsystem<UDestroyableSubsystem>())
+	{
+		Destroyables->ApplyPropDestroyed(PropId, bPlayEffects);
+	}
+}
+
+void ADestroyableManager::OnPropRestored(uint32 PropId)
+{
+	if (UDestroyableSubsystem* Destroyables = GetWorld()->GetSubsystem<UDestroyableSubsystem>())
+	{
+		Destroyables->ApplyPropRestored(PropId);
+	}
+}
@@ -0,0 +1,90 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Info.h"
+#include "Net/Serialization/FastArraySerializer.h"
+#include "DestroyableManager.generated.h"
+
+class ADestroyableManager;
+
+/** One destroyed prop, identified by ADestroyable::GetPropId */
+USTRUCT()
+struct FDestroyedProp : public FFastArraySerializerItem
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	uint32 PropId = 0;
+
+	void PostReplicatedAdd(const struct FDestroyedPropArray& InArraySerializer);
+	void PreReplicatedRemove(const struct FDestroyedPropArray& InArraySerializer);
+};
+
+USTRUCT()
+struct FDestroyedPropArray : public FFastArraySerializer
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TArray<FDestroyedProp> Items;
+
+	UPROPERTY(NotReplicated)
+	TObjectPtr<ADestroyableManager> Owner = nullptr;
+
+	//False until the first update arrives, props destroyed before we joined don't play effects
+	bool bReceivedInitialState = false;
+
+	void PostReplicatedReceive(const FFastArraySerializer::FPostReplicatedReceiveParameters& Parameters)
+	{
+		bReceivedInitialState = true;
+	}
+
+	bool NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms)
+	{
+		return FFastArraySerializer::FastArrayDeltaSerialize<FDestroyedProp, FDestroyedPropArray>(Items, DeltaParms, *this);
+	}
+};
+
+template<>
+struct TStructOpsTypeTraits<FDestroyedPropArray> : public TStructOpsTypeTraitsBase2<FDestroyedPropArray>
+{
+	enum
+	{
+		WithNetDeltaSerializer = true,
+	};
+};
+
+/**
+ * Replicates which destroyables are gone. Destroyables stay net dormant for the whole match,
+ * clients hide them when their id shows up here instead of every prop owning a channel and RPCs.
+ * Spawned on the server by UDestroyableSubsystem when the world begins play.
+ */
+UCLASS(NotPlaceable)
+class MOOMOOMADNESS_API ADestroyableManager : public AInfo
+{
+	GENERATED_BODY()
+
+public:
+	ADestroyableManager();
+
+	virtual void PostInitializeComponents() override;
+
+	/** Adds a prop to the destroyed list. Server only, returns false if it was already destroyed */
+	bool MarkDestroyed(uint32 PropId);
+
+	/** Removes a prop from the destroyed list so it shows up again. Server only */
+	bool MarkRestored(uint32 PropId);
+
+	/** Called on clients as the destroyed list changes */
+	void OnPropDestroyed(uint32 PropId, bool bPlayEffects);
+	void OnPropRestored(uint32 PropId);
+
+protected:
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
+private:
+	UPROPERTY(Replicated)
+	FDestroyedPropArray DestroyedProps;
+};
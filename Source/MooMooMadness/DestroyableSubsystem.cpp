@@ -0,0 +1,273 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "DestroyableSubsystem.h"
+
+#include "CowBroadphaseSubsystem.h"
+#include "Destroyable.h"
+#include "DestroyableManager.h"
+#include "InstancedDestroyableField.h"
+#include "TimerManager.h"
+
+void UDestroyableSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	if (InWorld.GetNetMode() == NM_Client)
+	{
+		return;
+	}
+
+	//Spawned before anything can be destroyed, so a client's first bunch from it is always empty and every later
+	//destruction arrives as a change that plays its effects
+	GetOrSpawnManager();
+
+	if (RespawnWaveInterval > 0.f)
+	{
+		InWorld.GetTimerManager().SetTimer(RespawnTimerHandle, FTimerDelegate::CreateWeakLambda(this, [this]() { RespawnWave(); }), RespawnWaveInterval, true);
+	}
+}
+
+void UDestroyableSubsystem::Deinitialize()
+{
+	if (UWorld* World = GetWorld())
+	{
+		World->GetTimerManager().ClearTimer(RespawnTimerHandle);
+	}
+
+	Super::Deinitialize();
+}
+
+uint32 UDestroyableSubsystem::MakePlacedActorId(const AActor* Actor)
+{
+	//Partitioned maps load actors into generated cell levels, but actor names stay unique across the whole map
+	const UWorld* World = Actor->GetWorld();
+	if (World && World->IsPartitionedWorld())
+	{
+		const FString MapName = UWorld::RemovePIEPrefix(World->GetOutermost()->GetName());
+		return FCrc::StrCrc32(*(MapName + TEXT(".") + Actor->GetName()));
+	}
+
+	//Placed props have the same path on the server and clients once the PIE prefix is gone
+	return FCrc::StrCrc32(*UWorld::RemovePIEPrefix(Actor->GetPathName()));
+}
+
+uint32 UDestroyableSubsystem::MakeSpawnedPropId()
+{
+	//Placed ids are hashes, skip any a loaded prop already has. Zero is left for props without an id
+	while (NextSpawnedPropId == 0 || Props.Contains(NextSpawnedPropId) || FieldInstances.Contains(NextSpawnedPropId))
+	{
+		NextSpawnedPropId++;
+	}
+	return NextSpawnedPropId++;
+}
+
+void UDestroyableSubsystem::Register(ADestroyable* Prop)
+{
+	const uint32 PropId = Prop->GetPropId();
+	if (const TWeakObjectPtr<ADestroyable>* Existing = Props.Find(PropId))
+	{
+		ensureMsgf(!Existing->IsValid() || Existing->Get() == Prop, TEXT("%s has the same prop id as %s"), *GetNameSafe(Prop), *GetNameSafe(Existing->Get()));
+	}
+	Props.Add(PropId, Prop);
+
+	//Destroyed before this prop was loaded
+	if (DestroyedPropIds.Contains(PropId))
+	{
+		Prop->SetDestroyed(true, false);
+	}
+}
+
+void UDestroyableSubsystem::Unregister(ADestroyable* Prop)
+{
+	const uint32 PropId = Prop->GetPropId();
+	if (Props.FindRef(PropId) == Prop)
+	{
+		Props.Remove(PropId);
+	}
+}
+
+void UDestroyableSubsystem::RegisterField(AInstancedDestroyableField* Field)
+{
+	const TArray<FDestroyableFieldEntry>& Entries = Field->GetEntries();
+	for (int32 EntryIndex = 0; EntryIndex < Entries.Num(); EntryIndex++)
+	{
+		for (int32 InstanceIndex = 0; InstanceIndex < Entries[EntryIndex].Instances.Num(); InstanceIndex++)
+		{
+			const uint32 PropId = Field->GetInstancePropId(EntryIndex, InstanceIndex);
+			ensureMsgf(!Props.Contains(PropId) && !FieldInstances.Contains(PropId), TEXT("%s has a prop id that is already taken"), *GetNameSafe(Field));
+			FieldInstances.Add(PropId, { Field, EntryIndex, InstanceIndex });
+
+			if (DestroyedPropIds.Contains(PropId))
+			{
+				Field->SetInstanceDestroyed(EntryIndex, InstanceIndex, true, false);
+			}
+		}
+	}
+}
+
+void UDestroyableSubsystem::UnregisterField(AInstancedDestroyableField* Field)
+{
+	const TArray<FDestroyableFieldEntry>& Entries = Field->GetEntries();
+	for (int32 EntryIndex = 0; EntryIndex < Entries.Num(); EntryIndex++)
+	{
+		for (int32 InstanceIndex = 0; InstanceIndex < Entries[EntryIndex].Instances.Num(); InstanceIndex++)
+		{
+			FieldInstances.Remove(Field->GetInstancePropId(EntryIndex, InstanceIndex));
+		}
+	}
+}
+
+bool UDestroyableSubsystem::DestroyProp(ADestroyable* Prop)
+{
+	return DestroyPropId(Prop->GetPropId());
+}
+
+bool UDestroyableSubsystem::DestroyPropId(uint32 PropId)
+{
+	ADestroyableManager* DestroyableManager = GetOrSpawnManager();
+	if (!DestroyableManager || !DestroyableManager->MarkDestroyed(PropId))
+	{
+		return false;
+	}
+
+	DestroyedTimes.Add(PropId, GetWorld()->GetTimeSeconds());
+
+	//The server and a listen server's player see it right away
+	ApplyPropDestroyed(PropId, true);
+	return true;
+}
+
+bool UDestroyableSubsystem::RestoreProp(ADestroyable* Prop)
+{
+	return RestorePropId(Prop->GetPropId());
+}
+
+bool UDestroyableSubsystem::RestorePropId(uint32 PropId)
+{
+	ADestroyableManager* DestroyableManager = GetOrSpawnManager();
+	if (!DestroyableManager || !DestroyableManager->MarkRestored(PropId))
+	{
+		return false;
+	}
+
+	DestroyedTimes.Remove(PropId);
+	ApplyPropRestored(PropId);
+	return true;
+}
+
+int32 UDestroyableSubsystem::RespawnWave()
+{
+	UWorld* World = GetWorld();
+	if (!World || World->GetNetMode() == NM_Client || DestroyedTimes.IsEmpty())
+	{
+		return 0;
+	}
+
+	//Oldest first, so a wave with a limit brings back what has been gone the longest
+	const double LatestDestroyTime = World->GetTimeSeconds() - MinRespawnDelay;
+	TArray<TPair<double, uint32>, TInlineAllocator<64>> Candidates;
+	for (const TPair<uint32, double>& Destroyed : DestroyedTimes)
+	{
+		if (Destroyed.Value <= LatestDestroyTime)
+		{
+			Candidates.Emplace(Destroyed.Value, Destroyed.Key);
+		}
+	}
+	Candidates.Sort([](const TPair<double, uint32>& A, const TPair<double, uint32>& B) { return A.Key < B.Key; });
+
+	const UCowBroadphaseSubsystem* Broadphase = World->GetSubsystem<UCowBroadphaseSubsystem>();
+	int32 NumRestored = 0;
+	for (const TPair<double, uint32>& Candidate : Candidates)
+	{
+		if (MaxPerWave > 0 && NumRestored >= MaxPerWave)
+		{
+			break;
+		}
+
+		//Popping back inside a cow would shove it out, leave the prop for the next wave
+		FBox Bounds;
+		if (Broadphase && GetPropBounds(Candidate.Value, Bounds))
+		{
+			TArray<AActor*, TInlineAllocator<4>> Cows;
+			Broadphase->Query(Bounds, ECowBroadphaseType::Cow, Cows);
+			if (Cows.Num() > 0)
+			{
+				continue;
+			}
+		}
+
+		if (RestorePropId(Candidate.Value))
+		{
+			NumRestored++;
+		}
+	}
+	return NumRestored;
+}
+
+bool UDestroyableSubsystem::GetPropBounds(uint32 PropId, FBox& OutBounds) const
+{
+	if (const ADestroyable* Prop = Props.FindRef(PropId).Get())
+	{
+		OutBounds = Prop->GetComponentsBoundingBox(true);
+		return true;
+	}
+	if (const FFieldInstance* FieldInstance = FieldInstances.Find(PropId))
+	{
+		if (const AInstancedDestroyableField* Field = FieldInstance->Field.Get())
+		{
+			OutBounds = Field->GetInstanceBounds(FieldInstance->EntryIndex, FieldInstance->InstanceIndex);
+			return true;
+		}
+	}
+	return false;
+}
+
+void UDestroyableSubsystem::ApplyPropDestroyed(uint32 PropId, bool bPlayEffects)
+{
+	DestroyedPropIds.Add(PropId);
+	if (ADestroyable* Prop = Props.FindRef(PropId).Get())
+	{
+		Prop->SetDestroyed(true, bPlayEffects);
+	}
+	else if (const FFieldInstance* FieldInstance = FieldInstances.Find(PropId))
+	{
+		if (AInstancedDestroyableField* Field = FieldInstance->Field.Get())
+		{
+			Field->SetInstanceDestroyed(FieldInstance->EntryIndex, FieldInstance->InstanceIndex, true, bPlayEffects);
+		}
+	}
+}
+
+void UDestroyableSubsystem::ApplyPropRestored(uint32 PropId)
+{
+	DestroyedPropIds.Remove(PropId);
+	if (ADestroyable* Prop = Props.FindRef(PropId).Get())
+	{
+		Prop->SetDestroyed(false, false);
+	}
+	else if (const FFieldInstance* FieldInstance = FieldInstances.Find(PropId))
+	{
+		if (AInstancedDestroyableField* Field = FieldInstance->Field.Get())
+		{
+			Field->SetInstanceDestroyed(FieldInstance->EntryIndex, FieldInstance->InstanceIndex, false, false);
+		}
+	}
+}
+
+bool UDestroyableSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+ADestroyableManager* UDestroyableSubsystem::GetOrSpawnManager()
+{
+	UWorld* World = GetWorld();
+	if (!Manager && World->GetNetMode() != NM_Client)
+	{
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.ObjectFlags |= RF_Transient;
+		Manager = World->SpawnActor<ADestroyableManager>(SpawnParams);
+	}
+	return Manager;
+}
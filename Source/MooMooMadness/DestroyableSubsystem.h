@@ -0,0 +1,105 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "DestroyableSubsystem.generated.h"
+
+class ADestroyable;
+class ADestroyableManager;
+class AInstancedDestroyableField;
+
+/**
+ * Looks up destroyables and instanced field entries by their stable prop id and applies destruction to them locally.
+ * On the server it owns the ADestroyableManager that replicates destruction, on clients it remembers
+ * which ids are destroyed so props that register late (streamed in by World Partition, or loaded after the manager)
+ * start hidden, and props streamed out and back in come back in the state they left.
+ * Destroyed props are never destroyed as actors, they stay loaded and dormant and the server brings them back
+ * in timed respawn waves, so long matches don't churn actors or replication channels.
+ */
+UCLASS(config=Game)
+class MOOMOOMADNESS_API UDestroyableSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual void Deinitialize() override;
+	void Register(ADestroyable* Prop);
+	void Unregister(ADestroyable* Prop);
+
+	/** Registers every instance of a field under its own prop id */
+	void RegisterField(AInstancedDestroyableField* Field);
+	void UnregisterField(AInstancedDestroyableField* Field);
+
+	/** Destroys a prop for everyone. Server only, returns false if it was already destroyed */
+	bool DestroyProp(ADestroyable* Prop);
+	bool DestroyPropId(uint32 PropId);
+
+	/** Brings a destroyed prop back for everyone. Server only */
+	bool RestoreProp(ADestroyable* Prop);
+	bool RestorePropId(uint32 PropId);
+
+	/** Applies replicated destruction state to the local prop, if it's loaded */
+	void ApplyPropDestroyed(uint32 PropId, bool bPlayEffects);
+	void ApplyPropRestored(uint32 PropId);
+
+	FORCEINLINE bool IsPropDestroyed(uint32 PropId) const { return DestroyedPropIds.Contains(PropId); }
+
+	/**
+	 * Id for a placed actor that the server and every client agree on, whichever level or streaming cell loaded it.
+	 * Only placed actors have the same name everywhere; actors spawned at runtime have to be given an id by the server.
+	 */
+	static uint32 MakePlacedActorId(const AActor* Actor);
+
+	/** Id for a destroyable spawned at runtime, not used by any prop registered so far. Server only, replicated by the prop */
+	uint32 MakeSpawnedPropId();
+
+	/** Restores the props that have been destroyed longest, up to MaxPerWave. Server only, returns how many came back */
+	UFUNCTION(BlueprintCallable, BlueprintAuthorityOnly, Category = "Destroyables")
+	int32 RespawnWave();
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	//Seconds between respawn waves, 0 turns timed respawning off
+	UPROPERTY(config)
+	float RespawnWaveInterval = 30.f;
+
+	//How long a prop stays destroyed before a wave can bring it back
+	UPROPERTY(config)
+	float MinRespawnDelay = 20.f;
+
+	//Most props one wave restores, 0 for no limit
+	UPROPERTY(config)
+	int32 MaxPerWave = 0;
+
+private:
+	ADestroyableManager* GetOrSpawnManager();
+
+	/** World bounds of a loaded prop, false if it isn't loaded here */
+	bool GetPropBounds(uint32 PropId, FBox& OutBounds) const;
+
+	FTimerHandle RespawnTimerHandle;
+
+	//Server time each prop was destroyed at, only kept on the server
+	TMap<uint32, double> DestroyedTimes;
+
+	UPROPERTY(Transient)
+	TObjectPtr<ADestroyableManager> Manager;
+
+	TMap<uint32, TWeakObjectPtr<ADestroyable>> Props;
+
+	struct FFieldInstance
+	{
+		TWeakObjectPtr<AInstancedDestroyableField> Field;
+		int32 EntryIndex;
+		int32 InstanceIndex;
+	};
+	TMap<uint32, FFieldInstance> FieldInstances;
+
+	TSet<uint32> DestroyedPropIds;
+
+	uint32 NextSpawnedPropId = 1;
+};
@@ -0,0 +1,28 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "DestroyableType.generated.h"
+
+class UStaticMesh;
+class USoundBase;
+
+/** Everything shared by every destroyable of one kind, so a field of hay bales stores it once instead of per prop */
+UCLASS(BlueprintType)
+class MOOMOOMADNESS_API UDestroyableType : public UDataAsset
+{
+	GENERATED_BODY()
+
+public:
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Destroyable")
+	TObjectPtr<UStaticMesh> Mesh;
+
+	//Points the cow that destroys it gets
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Score System")
+	int32 PointValue = 0;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Audio")
+	TObjectPtr<USoundBase> DestructionSound;
+};
@@ -0,0 +1,175 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "InstancedDestroyableField.h"
+
+#include "CowBroadphaseSubsystem.h"
+#include "CowDestructionAudioSubsystem.h"
+#include "DestroyableSubsystem.h"
+#include "DestroyableType.h"
+#include "Components/HierarchicalInstancedStaticMeshComponent.h"
+#include "Engine/CollisionProfile.h"
+#include "Engine/StaticMesh.h"
+
+AInstancedDestroyableField::AInstancedDestroyableField()
+{
+	PrimaryActorTick.bCanEverTick = false;
+
+	//Placed fields are addressed by path and their state arrives through ADestroyableManager, they never replicate themselves
+	bReplicates = false;
+
+	USceneComponent* Root = CreateDefaultSubobject<USceneComponent>(TEXT("Root"));
+	Root->SetMobility(EComponentMobility::Static);
+	RootComponent = Root;
+}
+
+void AInstancedDestroyableField::OnConstruction(const FTransform& Transform)
+{
+	Super::OnConstruction(Transform);
+
+	for (UHierarchicalInstancedStaticMeshComponent* MeshComponent : MeshComponents)
+	{
+		if (MeshComponent)
+		{
+			MeshComponent->DestroyComponent();
+		}
+	}
+	MeshComponents.Reset(Entries.Num());
+
+	for (const FDestroyableFieldEntry& Entry : Entries)
+	{
+		//Keep indices lined up with Entries even for entries that aren't filled in yet
+		UHierarchicalInstancedStaticMeshComponent* MeshComponent = nullptr;
+		if (Entry.Type && Entry.Type->Mesh)
+		{
+			MeshComponent = NewObject<UHierarchicalInstancedStaticMeshComponent>(this, NAME_None, RF_Transactional);
+			MeshComponent->CreationMethod = EComponentCreationMethod::UserConstructionScript;
+			MeshComponent->SetMobility(EComponentMobility::Static);
+			MeshComponent->SetStaticMesh(Entry.Type->Mesh);
+			//Cows still bump into the props, but the combat sweep is a multi sweep on visibility, like ADestroyable's
+			//HitBox the instances have to overlap it or the first one hit would hide everything behind it
+			MeshComponent->SetCollisionProfileName(UCollisionProfile::BlockAllDynamic_ProfileName);
+			MeshComponent->SetCollisionResponseToChannel(ECC_Visibility, ECR_Overlap);
+			MeshComponent->SetupAttachment(RootComponent);
+			MeshComponent->RegisterComponent();
+			MeshComponent->AddInstances(Entry.Instances, false, false);
+		}
+		MeshComponents.Add(MeshComponent);
+	}
+}
+
+#if WITH_EDITOR
+bool AInstancedDestroyableField::IsHLODRelevant() const
+{
+	return false;
+}
+#endif
+
+void AInstancedDestroyableField::BeginPlay()
+{
+	Super::BeginPlay();
+
+	DestroyedInstances.SetNum(Entries.Num());
+	for (int32 EntryIndex = 0; EntryIndex < Entries.Num(); EntryIndex++)
+	{
+		DestroyedInstances[EntryIndex].Init(false, Entries[EntryIndex].Instances.Num());
+	}
+
+	//The field never moves, the broadphase only has to know something destroyable is in its bounds
+	if (UCowBroadphaseSubsystem* Broadphase = GetWorld()->GetSubsystem<UCowBroadphaseSubsystem>())
+	{
+		Broadphase->Register(this, ECowBroadphaseType::Destroyable, false);
+	}
+
+	ensureMsgf(IsNetStartupActor() || GetNetMode() == NM_Standalone, TEXT("%s was spawned at runtime, clients can't match its instance ids"), *GetName());
+	FieldId = UDestroyableSubsystem::MakePlacedActorId(this);
+	if (UDestroyableSubsystem* Destroyables = GetWorld()->GetSubsystem<UDestroyableSubsystem>())
+	{
+		Destroyables->RegisterField(this);
+	}
+}
+
+void AInstancedDestroyableField::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UCowBroadphaseSubsystem* Broadphase = GetWorld()->GetSubsystem<UCowBroadphaseSubsystem>())
+	{
+		Broadphase->Unregister(this);
+	}
+	if (UDestroyableSubsystem* Destroyables = GetWorld()->GetSubsystem<UDestroyableSubsystem>())
+	{
+		Destroyables->UnregisterField(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+uint32 AInstancedDestroyableField::GetInstancePropId(int32 EntryIndex, int32 InstanceIndex) const
+{
+	return HashCombine(FieldId, GetTypeHash(((uint32)EntryIndex << 20) | (uint32)InstanceIndex));
+}
+
+int32 AInstancedDestroyableField::FindEntryIndex(const UPrimitiveComponent* Component) const
+{
+	return Component ? MeshComponents.IndexOfByKey(Component) : INDEX_NONE;
+}
+
+bool AInstancedDestroyableField::DestroyInstance(const UPrimitiveComponent* Component, int32 InstanceIndex)
+{
+	const int32 EntryIndex = FindEntryIndex(Component);
+	if (!HasAuthority() || EntryIndex == INDEX_NONE || IsInstanceDestroyed(EntryIndex, InstanceIndex)) { return false; }
+
+	UDestroyableSubsystem* Destroyables = GetWorld()->GetSubsystem<UDestroyableSubsystem>();
+	return Destroyables && Destroyables->DestroyPropId(GetInstancePropId(EntryIndex, InstanceIndex));
+}
+
+int32 AInstancedDestroyableField::GetPointValue(const UPrimitiveComponent* Component) const
+{
+	const int32 EntryIndex = FindEntryIndex(Component);
+	return EntryIndex != INDEX_NONE && Entries[EntryIndex].Type ? Entries[EntryIndex].Type->PointValue : 0;
+}
+
+bool AInstancedDestroyableField::IsInstanceDestroyed(int32 EntryIndex, int32 InstanceIndex) const
+{
+	//Out of range counts as destroyed so stale hits never score
+	return !DestroyedInstances.IsValidIndex(EntryIndex)
+		|| !DestroyedInstances[EntryIndex].IsValidIndex(InstanceIndex)
+		|| DestroyedInstances[EntryIndex][InstanceIndex];
+}
+
+FBox AInstancedDestroyableField::GetInstanceBounds(int32 EntryIndex, int32 InstanceIndex) const
+{
+	const FDestroyableFieldEntry& Entry = Entries[EntryIndex];
+	const FTransform InstanceTransform = Entry.Instances[InstanceIndex]*GetActorTransform();
+	if (Entry.Type && Entry.Type->Mesh)
+	{
+		return Entry.Type->Mesh->GetBounds().GetBox().TransformBy(InstanceTransform);
+	}
+	return FBox(InstanceTransform.GetLocation(), InstanceTransform.GetLocation());
+}
+
+void AInstancedDestroyableField::SetInstanceDestroyed(int32 EntryIndex, int32 InstanceIndex, bool bNewDestroyed, bool bPlayEffects)
+{
+	if (!DestroyedInstances.IsValidIndex(EntryIndex) || !DestroyedInstances[EntryIndex].IsValidIndex(InstanceIndex)) { return; }
+	if (DestroyedInstances[EntryIndex][InstanceIndex] == bNewDestroyed) { return; }
+	DestroyedInstances[EntryIndex][InstanceIndex] = bNewDestroyed;
+
+	UHierarchicalInstancedStaticMeshComponent* MeshComponent = MeshComponents.IsValidIndex(EntryIndex) ? MeshComponents[EntryIndex].Get() : nullptr;
+	if (!MeshComponent) { return; }
+
+	//Removing the instance would shift every index after it, a zero scale keeps them stable and drops the body
+	FTransform InstanceTransform = Entries[EntryIndex].Instances[InstanceIndex];
+	if (bNewDestroyed)
+	{
+		InstanceTransform.SetScale3D(FVector::ZeroVector);
+	}
+	MeshComponent->UpdateInstanceTransform(InstanceIndex, InstanceTransform, false, true, true);
+
+	if (bNewDestroyed && bPlayEffects && Entries[EntryIndex].Type)
+	{
+		if (UCowDestructionAudioSubsystem* DestructionAudio = GetWorld()->GetSubsystem<UCowDestructionAudioSubsystem>())
+		{
+			const FVector Location = GetActorTransform().TransformPosition(Entries[EntryIndex].Instances[InstanceIndex].GetLocation());
+			DestructionAudio->QueueDestruction(Entries[EntryIndex].Type->DestructionSound, Location);
+		}
+	}
+}
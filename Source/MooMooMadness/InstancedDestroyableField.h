@@ -0,0 +1,86 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "InstancedDestroyableField.generated.h"
+
+class UDestroyableType;
+class UHierarchicalInstancedStaticMeshComponent;
+
+/** Every instance of one destroyable type in a field */
+USTRUCT(BlueprintType)
+struct FDestroyableFieldEntry
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Field")
+	TObjectPtr<UDestroyableType> Type;
+
+	//Relative to the field
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Field", meta = (MakeEditWidget))
+	TArray<FTransform> Instances;
+};
+
+/**
+ * Many destroyables in one actor, drawn and collided through one hierarchical instanced mesh per type.
+ * Each instance gets a prop id like an ADestroyable and is destroyed through UDestroyableSubsystem the same way,
+ * destroyed instances are scaled to zero, which hides them and removes their physics body without reordering the rest.
+ * Combat hits resolve to an instance through FHitResult::Item.
+ * Fields have to be placed in the level, they don't replicate so a field spawned at runtime has no id clients can match.
+ */
+UCLASS()
+class MOOMOOMADNESS_API AInstancedDestroyableField : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	AInstancedDestroyableField();
+
+	virtual void OnConstruction(const FTransform& Transform) override;
+
+#if WITH_EDITOR
+	/** Kept out of HLOD like ADestroyable, a baked proxy would keep drawing destroyed instances */
+	virtual bool IsHLODRelevant() const override;
+#endif
+
+	/** Destroys the instance a hit landed on for everyone. Server only, returns false if it was already destroyed */
+	bool DestroyInstance(const UPrimitiveComponent* Component, int32 InstanceIndex);
+
+	/** Points for destroying an instance of the type drawn by Component */
+	int32 GetPointValue(const UPrimitiveComponent* Component) const;
+
+	/** Hides or shows one instance locally, called by UDestroyableSubsystem as destruction state replicates */
+	void SetInstanceDestroyed(int32 EntryIndex, int32 InstanceIndex, bool bNewDestroyed, bool bPlayEffects);
+
+	bool IsInstanceDestroyed(int32 EntryIndex, int32 InstanceIndex) const;
+
+	/** World bounds of an instance as it is when not destroyed */
+	FBox GetInstanceBounds(int32 EntryIndex, int32 InstanceIndex) const;
+
+	/** Id shared by the server and every client, built from the field's level path and the instance's place in Entries */
+	uint32 GetInstancePropId(int32 EntryIndex, int32 InstanceIndex) const;
+
+	FORCEINLINE const TArray<FDestroyableFieldEntry>& GetEntries() const { return Entries; }
+
+protected:
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Field", meta = (TitleProperty = "Type"))
+	TArray<FDestroyableFieldEntry> Entries;
+
+private:
+	/** Entry drawn by Component, INDEX_NONE if it isn't one of ours */
+	int32 FindEntryIndex(const UPrimitiveComponent* Component) const;
+
+	//One per entry, in the same order, rebuilt by OnConstruction
+	UPROPERTY(VisibleAnywhere, Category = "Components")
+	TArray<TObjectPtr<UHierarchicalInstancedStaticMeshComponent>> MeshComponents;
+
+	uint32 FieldId = 0;
+
+	//Destroyed flag per instance, one array per entry
+	TArray<TBitArray<>> DestroyedInstances;
+};
@@ -9,5 +9,10 @@ public class MooMooMadness : ModuleRules
 		PCHUsage = PCHUsageMode.UseExplicitOrSharedPCHs;
 
 		PublicDependencyModuleNames.AddRange(new string[] { "Core", "CoreUObject", "Engine", "InputCore", "EnhancedInput" });
+
+		PrivateDependencyModuleNames.AddRange(new string[] { "NetCore", "ReplicationGraph", "TraceLog", "AnimationBudgetAllocator" });
+
+		//Iris is compiled in but stays off unless net.Iris.UseIrisReplication is set
+		SetupIrisSupport(Target);
 	}
 }
@@ -3,3 +3,19 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "Net/Core/PushModel/PushModel.h"
+
+/**
+ * Assigns a push model replicated property on this object and marks it dirty, only if the value changed.
+ * Every property registered with bIsPushBased has to be written through this or MARK_PROPERTY_DIRTY_FROM_NAME,
+ * otherwise the change never replicates.
+ */
+#define SET_REPLICATED_PROPERTY(ClassName, PropertyName, NewValue) \
+	do \
+	{ \
+		if (PropertyName != (NewValue)) \
+		{ \
+			PropertyName = (NewValue); \
+			MARK_PROPERTY_DIRTY_FROM_NAME(ClassName, PropertyName, this); \
+		} \
+	} while (false)
@@ -1,6 +1,7 @@
 // Copyright Epic Games, Inc. All Rights Reserved.
 
 #include "MooMooMadnessCharacter.h"
+#include "MooMooMadness.h"
 #include "Engine/LocalPlayer.h"
 #include "Camera/CameraComponent.h"
 #include "Components/CapsuleComponent.h"
@@ -12,8 +13,14 @@
 #include "InputActionValue.h"
 #include "Animation/AnimMontage.h"
 #include "Animation/AnimInstance.h"
-#include "TimerManager.h"
+#include "CowAnimInstance.h"
+#include "SkeletalMeshComponentBudgeted.h"
 #include "Destroyable.h"
+#include "InstancedDestroyableField.h"
+#include "MooMooMadnessPlayerState.h"
+#include "CowBroadphaseSubsystem.h"
+#include "CowSignificanceSubsystem.h"
+#include "Components/AudioComponent.h"
 #include "Net/UnrealNetwork.h"
 
 
@@ -22,8 +29,13 @@ DEFINE_LOG_CATEGORY(LogTemplateCharacter);
 //////////////////////////////////////////////////////////////////////////
 // AMooMooMadnessCharacter
 
-AMooMooMadnessCharacter::AMooMooMadnessCharacter()
+AMooMooMadnessCharacter::AMooMooMadnessCharacter(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer.SetDefaultSubobjectClass<UCowMovementComponent>(ACharacter::CharacterMovementComponentName)
+		.SetDefaultSubobjectClass<USkeletalMeshComponentBudgeted>(ACharacter::MeshComponentName))
 {
+	//The animation budget allocator throttles the mesh by the significance ApplySignificance hands it, not its own guess
+	CastChecked<USkeletalMeshComponentBudgeted>(GetMesh())->SetAutoCalculateSignificance(false);
+
 	// Set size for collision capsule
 	GetCapsuleComponent()->InitCapsuleSize(42.f, 60.0f);
 		
@@ -56,9 +68,16 @@ AMooMooMadnessCharacter::AMooMooMadnessCharacter()
 	FollowCamera->SetupAttachment(CameraBoom, USpringArmComponent::SocketName); // Attach the camera to the end of the boom and let the boom adjust to match the controller orientation
 	FollowCamera->bUsePawnControlRotation = false; // Camera does not rotate relative to arm
 
+	// Create the combat component that sweeps for hits while an attack is active
+	CombatComponent = CreateDefaultSubobject<UCowCombatComponent>(TEXT("CombatComponent"));
+	LagCompensationComponent = CreateDefaultSubobject<UCowLagCompensationComponent>(TEXT("LagCompensationComponent"));
+	NetPriorityComponent = CreateDefaultSubobject<UCowNetPriorityComponent>(TEXT("NetPriorityComponent"));
+
 	// Note: The skeletal mesh and anim blueprint references on the Mesh component (inherited from Character) 
 	// are set in the derived blueprint asset named ThirdPersonCharacter (to avoid direct content references in C++)
 	bReplicates = true;
+
+	ResolvedAttackTable = GetDefault<UCowAttackTable>();
 }
 
 void AMooMooMadnessCharacter::BeginPlay()
@@ -66,6 +85,9 @@ void AMooMooMadnessCharacter::BeginPlay()
 	// Call the base class  
 	Super::BeginPlay();
 
+	//Resolve the attack tuning once so the combat code only ever indexes into it
+	ResolvedAttackTable = AttackTable ? AttackTable : GetDefault<UCowAttackTable>();
+
 	//Add Input Mapping Context
 	if (APlayerController* PlayerController = Cast<APlayerController>(Controller))
 	{
@@ -77,14 +99,120 @@ void AMooMooMadnessCharacter::BeginPlay()
 		//FRotator Rotation(-25.f, 180.f, 0.f);
 		//PlayerController->SetControlRotation(Rotation);
 	}
-	
+
+	if (UCowBroadphaseSubsystem* Broadphase = GetWorld()->GetSubsystem<UCowBroadphaseSubsystem>())
+	{
+		Broadphase->Register(this, ECowBroadphaseType::Cow, true);
+	}
+	if (UCowSignificanceSubsystem* Significance = GetWorld()->GetSubsystem<UCowSignificanceSubsystem>())
+	{
+		Significance->Register(this);
+	}
+}
+
+void AMooMooMadnessCharacter::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UCowBroadphaseSubsystem* Broadphase = GetWorld()->GetSubsystem<UCowBroadphaseSubsystem>())
+	{
+		Broadphase->Unregister(this);
+	}
+	if (UCowSignificanceSubsystem* Significance = GetWorld()->GetSubsystem<UCowSignificanceSubsystem>())
+	{
+		Significance->Unregister(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
 }
 
 void AMooMooMadnessCharacter::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
 {
 	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
 
-	DOREPLIFETIME(AMooMooMadnessCharacter, Invincible);
+	//Everything here is push based, write it through SET_REPLICATED_PROPERTY
+	FDoRepLifetimeParams Params;
+	Params.bIsPushBased = true;
+	DOREPLIFETIME_WITH_PARAMS_FAST(AMooMooMadnessCharacter, Invincible, Params);
+	DOREPLIFETIME_WITH_PARAMS_FAST(AMooMooMadnessCharacter, bIsStunned, Params);
+
+	Params.Condition = COND_SimulatedOnly;
+	DOREPLIFETIME_WITH_PARAMS_FAST(AMooMooMadnessCharacter, bIsSprinting, Params);
+
+	Params.Condition = COND_SkipOwner;
+	DOREPLIFETIME_WITH_PARAMS_FAST(AMooMooMadnessCharacter, HeadbuttCount, Params);
+
+	//Movement goes out quantized in CowRepMovement, the owner gets its corrections from the movement component
+	DISABLE_REPLICATED_PRIVATE_PROPERTY(AActor, ReplicatedMovement);
+	DOREPLIFETIME_CONDITION(AMooMooMadnessCharacter, CowRepMovement, COND_SimulatedOnly);
+}
+
+void AMooMooMadnessCharacter::PostInitializeComponents()
+{
+	Super::PostInitializeComponents();
+
+	CowRepMovement.Bounds = ReplicatedMovementBounds;
+	CowRepMovement.LocationPrecision = ReplicatedMovementPrecision;
+
+	//The anim instance is rebuilt whenever the mesh or anim class changes
+	GetMesh()->OnAnimInitialized.AddUniqueDynamic(this, &AMooMooMadnessCharacter::TrackMontages);
+	TrackMontages();
+}
+
+void AMooMooMadnessCharacter::TrackMontages()
+{
+	if (UCowAnimInstance* CowAnimInstance = Cast<UCowAnimInstance>(GetMesh()->GetAnimInstance()))
+	{
+		CowAnimInstance->SetTrackedMontage(ECowMontage::HeadbuttCharge, HeadButtChargeAnim);
+		CowAnimInstance->SetTrackedMontage(ECowMontage::Headbutt, HeadButtAnim);
+		CowAnimInstance->SetTrackedMontage(ECowMontage::Jump, JumpAnim);
+		CowAnimInstance->SetTrackedMontage(ECowMontage::Kick, KickAnim);
+	}
+}
+
+bool AMooMooMadnessCharacter::IsMontagePlaying(ECowMontage Montage) const
+{
+	UAnimInstance* AnimInstance = GetMesh()->GetAnimInstance();
+	if (const UCowAnimInstance* CowAnimInstance = Cast<UCowAnimInstance>(AnimInstance))
+	{
+		return CowAnimInstance->IsMontagePlaying(Montage);
+	}
+
+	//Anim blueprints not reparented to UCowAnimInstance yet, ask the montage system
+	const UAnimMontage* Assets[] = { HeadButtChargeAnim, HeadButtAnim, JumpAnim, KickAnim };
+	const UAnimMontage* Asset = Assets[(uint8)Montage];
+	return AnimInstance && Asset && AnimInstance->Montage_IsActive(Asset);
+}
+
+void AMooMooMadnessCharacter::PostNetInit()
+{
+	Super::PostNetInit();
+
+	//Runs once the initial bunch is in, also when the cow comes back into relevancy as a fresh actor
+	LastSeenHeadbuttCount = HeadbuttCount;
+	bHasSeenHeadbuttCount = true;
+}
+
+void AMooMooMadnessCharacter::PreReplication(IRepChangedPropertyTracker& ChangedPropertyTracker)
+{
+	//Gathers ReplicatedMovement, which is only copied from here on
+	Super::PreReplication(ChangedPropertyTracker);
+
+	const FRepMovement& Movement = GetReplicatedMovement();
+	CowRepMovement.Location = Movement.Location;
+	CowRepMovement.Velocity = Movement.LinearVelocity;
+	CowRepMovement.Yaw = Movement.Rotation.Yaw;
+}
+
+void AMooMooMadnessCharacter::OnRep_CowRepMovement()
+{
+	//A delta against a state we never got, wait for the next keyframe
+	if (!CowRepMovement.HasValidState()) { return; }
+
+	FRepMovement& Movement = GetReplicatedMovement_Mutable();
+	Movement.Location = CowRepMovement.Location;
+	Movement.Rotation = FRotator(0.f, CowRepMovement.Yaw, 0.f);
+	Movement.LinearVelocity = CowRepMovement.Velocity;
+	Movement.bRepPhysics = false;
+	OnRep_ReplicatedMovement();
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -156,178 +284,226 @@ void AMooMooMadnessCharacter::Look(const FInputActionValue& Value)
 //Sprint
 void AMooMooMadnessCharacter::Sprint()
 {
-	if (Controller != nullptr && GetCharacterMovement()->GetMaxSpeed() < 650.f && Stamina > 0.f)
+	//Sprint is predicted by the movement component, the server picks it up from the saved moves
+	if (Controller != nullptr && !GetCowMovement()->IsSprinting() && Stamina > 0.f)
 	{
-		Server_Sprint();
+		GetCowMovement()->SetWantsToSprint(true);
 		//DepleteStamina();
 	}
 }
 
-bool AMooMooMadnessCharacter::Server_Sprint_Validate()
+//Stop Sprinting
+void AMooMooMadnessCharacter::StopSprinting()
 {
-	return true;
+	if (Controller != nullptr)
+	{
+		GetCowMovement()->SetWantsToSprint(false);
+		//PauseStamina();
+	}
 }
 
-void AMooMooMadnessCharacter::Server_Sprint_Implementation()
+void AMooMooMadnessCharacter::OnSprintChanged(bool bSprinting)
 {
-	Multi_Sprint();
-	
-	// Start the timer
-	float Delay = 0.1f;
-	FTimerDelegate TimerDelegate;
-	FName Attack = "Charge";
-	TimerDelegate.BindUObject(this, &AMooMooMadnessCharacter::CombatTrace, 50.f, Attack);
-	GetWorldTimerManager().SetTimer(LT_TimerHandle, TimerDelegate, Delay, true);
+	SET_REPLICATED_PROPERTY(AMooMooMadnessCharacter, bIsSprinting, bSprinting);
+
+	if (bSprinting)
+	{
+		CombatComponent->BeginAttack(ECowAttack::Charge);
+	}
+	else if (CombatComponent->GetActiveAttack() == ECowAttack::Charge)
+	{
+		CombatComponent->EndAttack();
+	}
+	NetPriorityComponent->RefreshActivity();
 }
 
-bool AMooMooMadnessCharacter::Multi_Sprint_Validate()
+void AMooMooMadnessCharacter::ReleaseHeadButt()
 {
-	return true;
+	if (Controller != nullptr && !HBOnCooldown && Stamina > 0.f)
+	{
+		//Release head butt charge if player is currently charging
+		if (HeadButtAnim && !IsMontagePlaying(ECowMontage::HeadbuttCharge))
+		{
+			//Start cooldown and lunge right away, the server replays the lunge from the saved move
+			HBOnCooldown = true;
+			StartHBCooldown();
+			GetCowMovement()->RequestHeadbutt();
+			PlayHeadbuttEffects();
+		}
+		HeadButtStrength = 0.0;
+	}
 }
 
-void AMooMooMadnessCharacter::Multi_Sprint_Implementation()
+bool AMooMooMadnessCharacter::ServerAcceptHeadbutt()
 {
-	GetCharacterMovement()->MaxWalkSpeed = 650.f;
+	if (!HasAuthority()) { return false; }
+
+	//A listen server's own cow already checked and started its cooldown in ReleaseHeadButt
+	if (IsLocallyControlled()) { return true; }
+
+	//Rejecting leaves the client's predicted lunge to be corrected away
+	if (HBOnCooldown || Stamina <= 0.f) { return false; }
+
+	HBOnCooldown = true;
+	StartHBCooldown();
+	return true;
 }
 
-//Stop Sprinting
-void AMooMooMadnessCharacter::StopSprinting()
+void AMooMooMadnessCharacter::OnHeadbuttStarted()
 {
-	if (Controller != nullptr)
+	//The owner already played the effects when it predicted the lunge
+	if (!IsLocallyControlled())
 	{
-		Server_StopSprinting();
-		//PauseStamina();
+		PlayHeadbuttEffects();
 	}
+	SET_REPLICATED_PROPERTY(AMooMooMadnessCharacter, HeadbuttCount, HeadbuttCount + 1);
+	CombatComponent->BeginAttack(ECowAttack::Headbutt);
+	NetPriorityComponent->RefreshActivity();
 }
 
-bool AMooMooMadnessCharacter::Server_StopSprinting_Validate()
+void AMooMooMadnessCharacter::OnRep_HeadbuttCount()
 {
-	return true;
-}
+	//The initial bunch only tells us where the count is, PostNetInit starts watching it
+	const bool bNewHeadbutt = bHasSeenHeadbuttCount && HeadbuttCount != LastSeenHeadbuttCount;
+	LastSeenHeadbuttCount = HeadbuttCount;
 
-void AMooMooMadnessCharacter::Server_StopSprinting_Implementation()
-{
-	GetWorldTimerManager().ClearTimer(LT_TimerHandle);
-	Multi_StopSprinting();
+	if (bNewHeadbutt)
+	{
+		PlayHeadbuttEffects();
+	}
 }
 
-bool AMooMooMadnessCharacter::Multi_StopSprinting_Validate()
+void AMooMooMadnessCharacter::PlayHeadbuttEffects()
 {
-	return true;
+	//Call bp function to stop charging and play release anim
+	StopCharge();
+	//PlayAnimMontage(HeadButtAnim, 1.f, "ReleaseAttack");
+	PlayAnimMontage(JumpAnim, 1.5f, "HeadButtStart");
 }
 
-void AMooMooMadnessCharacter::Multi_StopSprinting_Implementation()
+void AMooMooMadnessCharacter::SetInvincible(bool bNewInvincible)
 {
-	GetCharacterMovement()->MaxWalkSpeed = 250.f;
+	SET_REPLICATED_PROPERTY(AMooMooMadnessCharacter, Invincible, bNewInvincible);
 }
 
-void AMooMooMadnessCharacter::ReleaseHeadButt()
+void AMooMooMadnessCharacter::SetStunned(bool bNewStunned)
 {
-	if (Controller != nullptr && !HBOnCooldown && Stamina > 0.f)
+	if (!HasAuthority()) { return; }
+
+	SET_REPLICATED_PROPERTY(AMooMooMadnessCharacter, bIsStunned, bNewStunned);
+
+	//Another hit while stunned restarts the stun
+	if (bNewStunned)
 	{
-		//Release head butt charge if player is currently charging
-		UAnimInstance* CowMeshInstance = GetMesh()->GetAnimInstance();
-		if (HeadButtAnim && !CowMeshInstance->Montage_IsActive(HeadButtChargeAnim))
-		{
-			//Start cooldown and call replicated function
-			HBOnCooldown = true;
-			StartHBCooldown();
-			Server_ReleaseHeadButt();
-		}
-		HeadButtStrength = 0.0;
+		GetWorldTimerManager().SetTimer(StunTimerHandle, FTimerDelegate::CreateUObject(this, &AMooMooMadnessCharacter::SetStunned, false), StunTime, false);
 	}
+	else
+	{
+		GetWorldTimerManager().ClearTimer(StunTimerHandle);
+	}
+	NetPriorityComponent->RefreshActivity();
 }
 
-bool AMooMooMadnessCharacter::Server_ReleaseHeadButt_Validate()
+void AMooMooMadnessCharacter::UpdateScore_Implementation(int32 Points)
 {
-	return true;
+	if (AMooMooMadnessPlayerState* CowPlayerState = GetPlayerState<AMooMooMadnessPlayerState>())
+	{
+		CowPlayerState->AddPoints(Points);
+	}
 }
 
-void AMooMooMadnessCharacter::Server_ReleaseHeadButt_Implementation()
+int32 AMooMooMadnessCharacter::GetScore() const
 {
-	UE_LOG(LogTemp, Warning, TEXT("Server Implementation."))
-
-	Multi_ReleaseHeadButt();
-	
-	// Start the timer
-	float Delay = 0.1f;
-	FTimerDelegate TimerDelegate;
-	FName Attack = "Headbutt";
-	TimerDelegate.BindUObject(this, &AMooMooMadnessCharacter::CombatTrace, 50.f, Attack);
-	GetWorldTimerManager().SetTimer(LT_TimerHandle, TimerDelegate, Delay, true);
+	const AMooMooMadnessPlayerState* CowPlayerState = GetPlayerState<AMooMooMadnessPlayerState>();
+	return CowPlayerState ? CowPlayerState->GetPoints() : 0;
 }
 
-bool AMooMooMadnessCharacter::Multi_ReleaseHeadButt_Validate()
+void AMooMooMadnessCharacter::SetScore(int32 NewScore)
 {
-	return true;
+	//AddPoints ignores clients and zero deltas
+	UpdateScore_Implementation(NewScore - GetScore());
 }
 
-void AMooMooMadnessCharacter::Multi_ReleaseHeadButt_Implementation()
+//Headbutts last as long as the lunge, charges until sprinting stops
+bool AMooMooMadnessCharacter::IsAttackWindowOpen(ECowAttack Attack) const
 {
-	UE_LOG(LogTemp, Warning, TEXT("Multicast Implementation."))
-	//Call bp function to stop charging and play release anim
-	StopCharge();
-	//PlayAnimMontage(HeadButtAnim, 1.f, "ReleaseAttack");
-	PlayAnimMontage(JumpAnim, 1.5f, "HeadButtStart");
-	FVector Velocity = GetActorForwardVector()*1250.f;
-	LaunchCharacter(Velocity, true, false);
+	if (Attack == ECowAttack::Headbutt)
+	{
+		return GetCowMovement()->IsHeadbutting() || GetCowMovement()->IsSprinting();
+	}
+	return Attack != ECowAttack::None;
 }
 
 //Detect if player hit another player
-void AMooMooMadnessCharacter::CombatTrace(float Distance, FName Attack)
+bool AMooMooMadnessCharacter::ApplyCombatHit(const FHitResult& Hit, ECowAttack Attack)
 {
-	UWorld* World = GetWorld();
-	if (!World) { return; }
-
-	//Initialize sphere trace variables
-	TArray<FHitResult> OutHits;
-	FVector Direction = GetActorForwardVector();
-	FVector Start = GetMesh()->GetBoneLocation("Neck3", EBoneSpaces::WorldSpace) + FVector(0.f, 0.f, -20.f);
-	FVector End = Start + Direction*Distance;
-	FCollisionQueryParams CollisionParams;
-	CollisionParams.AddIgnoredActor(this);
-	
-	//Call sphere trace and detect hit
-	//DrawDebugSphere(World, Start, 40.f, 12, FColor::Red, false, 3.f);
-	FCollisionShape ColShape = FCollisionShape::MakeSphere(40.f);
-	World->SweepMultiByChannel(OutHits, Start, End, FQuat::Identity,ECC_Visibility, ColShape, CollisionParams);
-	for ( FHitResult OutHit : OutHits)
+	//Check if hit is valid
+	AActor* HitActor = Hit.GetActor();
+	if (!HitActor) { return false; }
+
+	//Check if hit is another player to apply stun
+	if (AMooMooMadnessCharacter* HitPlayer = Cast<AMooMooMadnessCharacter>(HitActor))
 	{
-		if (Attack == "Headbutt" && !GetMesh()->GetAnimInstance()->Montage_IsActive(JumpAnim) && GetCharacterMovement()->GetMaxSpeed() < 650.f)
+		UE_LOG(LogTemplateCharacter, Verbose, TEXT("%s hit %s"), *GetNameSafe(this), *GetNameSafe(HitPlayer));
+		if (!HitPlayer->Invincible)
 		{
-			GetWorldTimerManager().ClearTimer(LT_TimerHandle);
+			const FCowAttackKernel& Kernel = GetAttackKernel(Attack);
+			SetTempInvincible(Kernel.InvincibleTime);
+			UpdateScore(Kernel.HitScore);
+			ClearDecreaseScoreTimer();
+			HitPlayer->SetStunned(true);
+			HitPlayer->Stun(GetActorForwardVector());
+			HitPlayer->UpdateScore(Kernel.VictimScore);
+			return true;
 		}
+	}
+	else if (ADestroyable* HitDestroyable = Cast<ADestroyable>(HitActor))
+	{
+		//Another cow may have destroyed it this frame
+		if (!HitDestroyable->DestroySelf()) { return false; }
 
-		//Check if hit is valid
-		AActor* HitActor = OutHit.GetActor();
-		if (!HitActor) { break; }
-	
-		//Check if hit is another player to apply stun
-		if (HitActor->IsA(AMooMooMadnessCharacter::StaticClass()))
-		{
-			UE_LOG(LogTemp, Warning, TEXT("This Bish was hit!"));
-			AMooMooMadnessCharacter* HitPlayer = Cast<AMooMooMadnessCharacter>(OutHit.GetActor());
-			if (HitPlayer && !HitPlayer->Invincible)
-			{
-				SetTempInvincible(1.50);
-				UpdateScore(10);
-				ClearDecreaseScoreTimer();
-				HitPlayer->Stun(GetActorForwardVector());
-				HitPlayer->UpdateScore(-10);
-			}
-		}
-		else if (HitActor->IsA(ADestroyable::StaticClass()))
-		{
-			ADestroyable* HitDestroyable = Cast<ADestroyable>(OutHit.GetActor());
-			if (HitDestroyable)
-			{
-				UpdateScore(HitDestroyable->GetPointValue());
-				HitDestroyable->DestroySelf();
-			}
-		}
+		UpdateScore(HitDestroyable->GetPointValue());
+		return true;
 	}
+	else if (AInstancedDestroyableField* HitField = Cast<AInstancedDestroyableField>(HitActor))
+	{
+		//Instanced hits carry the instance index in Item
+		if (!HitField->DestroyInstance(Hit.GetComponent(), Hit.Item)) { return false; }
+
+		UpdateScore(HitField->GetPointValue(Hit.GetComponent()));
+		return true;
+	}
+	return false;
 }
 
+void AMooMooMadnessCharacter::ApplySignificance(const FCowSignificanceSettings& Settings)
+{
+	AnimSignificance = Settings.AnimSignificance;
+	UpdateAnimationBudget();
+	GetMesh()->SetCastShadow(Settings.bCastShadows);
 
+	TInlineComponentArray<UAudioComponent*> AudioComponents(this);
+	for (UAudioComponent* AudioComponent : AudioComponents)
+	{
+		AudioComponent->bOverridePriority = true;
+		AudioComponent->Priority = Settings.AudioPriority;
+	}
+}
+
+void AMooMooMadnessCharacter::UpdateAnimationBudget()
+{
+	if (USkeletalMeshComponentBudgeted* BudgetedMesh = Cast<USkeletalMeshComponentBudgeted>(GetMesh()))
+	{
+		//Attacks are swept from the neck bone on the server, so a listen server keeps every cow at full rate, as does the local cow
+		const bool bNeverSkip = GetNetMode() != NM_Client || IsLocallyControlled();
+		BudgetedMesh->SetComponentSignificance(bNeverSkip ? 1.f : AnimSignificance, bNeverSkip);
+	}
+}
 
+void AMooMooMadnessCharacter::NotifyControllerChanged()
+{
+	Super::NotifyControllerChanged();
 
+	//Possession can arrive after the significance was applied, the local cow must never be skipped
+	UpdateAnimationBudget();
+}
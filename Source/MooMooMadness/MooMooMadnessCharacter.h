@@ -5,6 +5,12 @@
 #include "CoreMinimal.h"
 #include "GameFramework/Character.h"
 #include "Logging/LogMacros.h"
+#include "CowCombatComponent.h"
+#include "CowLagCompensationComponent.h"
+#include "CowMovementComponent.h"
+#include "CowNetPriorityComponent.h"
+#include "CowRepMovement.h"
+#include "CowAnimInstance.h"
 #include "MooMooMadnessCharacter.generated.h"
 
 class USpringArmComponent;
@@ -13,6 +19,7 @@ class UInputMappingContext;
 class UInputAction;
 struct FInputActionValue;
 class UAnimMontage;
+struct FCowSignificanceSettings;
 
 
 DECLARE_LOG_CATEGORY_EXTERN(LogTemplateCharacter, Log, All);
@@ -29,6 +36,18 @@ class AMooMooMadnessCharacter : public ACharacter
 	/** Follow camera */
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Camera, meta = (AllowPrivateAccess = "true"))
 	UCameraComponent* FollowCamera;
+
+	/** Hit detection for headbutts and charges */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Combat, meta = (AllowPrivateAccess = "true"))
+	UCowCombatComponent* CombatComponent;
+
+	/** Recent hitbox history so attackers can be checked against what they saw */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Combat, meta = (AllowPrivateAccess = "true"))
+	UCowLagCompensationComponent* LagCompensationComponent;
+
+	/** Raises and lowers the net update rate with what the cow is doing */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Network, meta = (AllowPrivateAccess = "true"))
+	UCowNetPriorityComponent* NetPriorityComponent;
 	
 	/** MappingContext */
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Input, meta = (AllowPrivateAccess = "true"))
@@ -55,7 +74,7 @@ class AMooMooMadnessCharacter : public ACharacter
 	UInputAction* HeadButtAction;
 
 public:
-	AMooMooMadnessCharacter();
+	AMooMooMadnessCharacter(const FObjectInitializer& ObjectInitializer);
 
 protected:
 
@@ -71,26 +90,6 @@ protected:
 	UFUNCTION (BlueprintCallable)
 	void StopSprinting();
 
-	UFUNCTION (Server, Reliable, WithValidation)
-	void Server_Sprint();
-	bool Server_Sprint_Validate();
-	void Server_Sprint_Implementation();
-
-	UFUNCTION(NetMulticast, Reliable, WithValidation)
-	void Multi_Sprint();
-	bool Multi_Sprint_Validate();
-	void Multi_Sprint_Implementation();
-
-	UFUNCTION (Server, Reliable, WithValidation)
-	void Server_StopSprinting();
-	bool Server_StopSprinting_Validate();
-	void Server_StopSprinting_Implementation();
-
-	UFUNCTION(NetMulticast, Reliable, WithValidation)
-	void Multi_StopSprinting();
-	bool Multi_StopSprinting_Validate();
-	void Multi_StopSprinting_Implementation();
-
 	/** Called for HeadButt input */
 	UFUNCTION (BlueprintImplementableEvent)
 	void ChargeHeadButt();
@@ -100,15 +99,20 @@ protected:
 	UFUNCTION (BlueprintImplementableEvent)
 	void StopCharge();
 
-	UFUNCTION (Server, Reliable, WithValidation)
-	void Server_ReleaseHeadButt();
-	bool Server_ReleaseHeadButt_Validate();
-	void Server_ReleaseHeadButt_Implementation();
+	/** Stops the charge and plays the release montage, the lunge itself is driven by the movement component */
+	void PlayHeadbuttEffects();
+
+	//Bumped by the server on every headbutt so other clients play the effects
+	UPROPERTY(ReplicatedUsing = OnRep_HeadbuttCount)
+	uint8 HeadbuttCount = 0;
+
+	UFUNCTION()
+	void OnRep_HeadbuttCount();
 
-	UFUNCTION(NetMulticast, Reliable, WithValidation)
-	void Multi_ReleaseHeadButt();
-	bool Multi_ReleaseHeadButt_Validate();
-	void Multi_ReleaseHeadButt_Implementation();
+	//HeadbuttCount as last seen on this client, so joining or re-entering relevancy doesn't replay an old headbutt.
+	//Only compared once PostNetInit has run
+	uint8 LastSeenHeadbuttCount = 0;
+	bool bHasSeenHeadbuttCount = false;
 
 	//Determines how powerful the head butt will be
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Combat, meta = (AllowPrivateAccess = "true"))
@@ -137,16 +141,31 @@ protected:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Combat, meta = (AllowPrivateAccess = "true"))
 	UAnimMontage* KickAnim;
 
-	//Line Trace for combat attacks
-	void CombatTrace(float Distance, FName Attack);
-	FTimerHandle LT_TimerHandle;
+	//Tuning for every attack, the class defaults are used when unset
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Combat, meta = (AllowPrivateAccess = "true"))
+	UCowAttackTable* AttackTable;
 
 	UFUNCTION (BlueprintImplementableEvent)
 	void Stun(FVector Direction);
 
-	UPROPERTY (Replicated, EditAnywhere, BlueprintReadWrite, meta = (AllowPrivateAccess = "true"))
+	UPROPERTY (Replicated, EditAnywhere, BlueprintReadWrite, BlueprintSetter = SetInvincible, meta = (AllowPrivateAccess = "true"))
 	bool Invincible;
 
+	UFUNCTION (BlueprintSetter)
+	void SetInvincible(bool bNewInvincible);
+
+	//How long a cow stays stunned after being hit
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Combat, meta = (AllowPrivateAccess = "true", ClampMin = "0"))
+	float StunTime = 1.5f;
+
+	//Set by the server while the cow is stunned
+	UPROPERTY (Replicated, BlueprintReadOnly, Category = Combat, meta = (AllowPrivateAccess = "true"))
+	bool bIsStunned = false;
+
+	//Mirrors the movement component's sprint for simulated proxies, which don't get the saved moves
+	UPROPERTY (Replicated, BlueprintReadOnly, Category = Movement, meta = (AllowPrivateAccess = "true"))
+	bool bIsSprinting = false;
+
 	UFUNCTION (BlueprintImplementableEvent)
 	void SetTempInvincible(float Time);
 	
@@ -160,19 +179,36 @@ protected:
 	UFUNCTION (BlueprintImplementableEvent)
 	void PauseStamina();
 
-	//Score
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (AllowPrivateAccess = "true"))
+	//Score, kept in the player state so it survives the pawn. Blueprint reads and writes go through GetScore and SetScore
+	UPROPERTY(Transient, BlueprintGetter = GetScore, BlueprintSetter = SetScore, meta = (AllowPrivateAccess = "true"))
 	int32 Score = 0;
 
-	UFUNCTION (BlueprintImplementableEvent, BlueprintCallable)
+	//Adds to the score kept in this cow's player state, does nothing on clients. Blueprint overrides should call the parent
+	UFUNCTION (BlueprintNativeEvent, BlueprintCallable)
 	void UpdateScore(int32 Points);
 
+	//Score from the player state, 0 while unpossessed
+	UFUNCTION (BlueprintGetter)
+	int32 GetScore() const;
+
+	//Moves the player state's score to NewScore, does nothing on clients
+	UFUNCTION (BlueprintSetter)
+	void SetScore(int32 NewScore);
+
 	UFUNCTION (BlueprintImplementableEvent)
 	void ClearDecreaseScoreTimer();
 	
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (AllowPrivateAccess = "true"))
 	float MouseSens = 0.6f;
 
+	//Space cow locations are quantized in for replication, cows outside it are clamped to the edge
+	UPROPERTY(EditDefaultsOnly, Category = Network)
+	FBox ReplicatedMovementBounds = FBox(FVector(-50000.f, -50000.f, -5000.f), FVector(50000.f, 50000.f, 20000.f));
+
+	//Size of one replicated location step
+	UPROPERTY(EditDefaultsOnly, Category = Network, meta = (ClampMin = "0.1", ForceUnits = "cm"))
+	float ReplicatedMovementPrecision = 1.f;
+
 protected:
 	// APawn interface
 	virtual void SetupPlayerInputComponent(class UInputComponent* PlayerInputComponent) override;
@@ -180,12 +216,86 @@ protected:
 	// To add mapping context
 	virtual void BeginPlay();
 
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 	void GetLifetimeReplicatedProps(TArray< FLifetimeProperty > & OutLifetimeProps) const override;
 
+	virtual void PostInitializeComponents() override;
+
+	virtual void PostNetInit() override;
+
+	virtual void NotifyControllerChanged() override;
+
+	virtual void PreReplication(IRepChangedPropertyTracker& ChangedPropertyTracker) override;
+
+private:
+	//Drives the input handlers directly during load tests
+	friend class UCowLoadTestSubsystem;
+
+	FTimerHandle StunTimerHandle;
+
+	//Replaces ReplicatedMovement for simulated proxies
+	UPROPERTY(ReplicatedUsing = OnRep_CowRepMovement)
+	FCowRepMovement CowRepMovement;
+
+	UFUNCTION()
+	void OnRep_CowRepMovement();
+
+	//AttackTable or the class default table, never null
+	UPROPERTY(Transient)
+	const UCowAttackTable* ResolvedAttackTable;
+
+	/** Hands AnimSignificance to the animation budget allocator, at full rate and never skipped where bones matter */
+	void UpdateAnimationBudget();
+
+	//Last significance ApplySignificance gave the mesh, kept for when the controller changes
+	float AnimSignificance = 1.f;
+
+	/** Hands the loaded montages to the mesh's UCowAnimInstance, again whenever the anim instance is rebuilt */
+	UFUNCTION()
+	void TrackMontages();
+
 public:
+	/** Opens or closes the charge attack, called on the server by the movement component */
+	void OnSprintChanged(bool bSprinting);
+
+	/** Stuns the cow for StunTime, or ends the stun early. Server only */
+	void SetStunned(bool bNewStunned);
+
+	FORCEINLINE bool IsStunned() const { return bIsStunned; }
+
+	/** Checks cooldown and stamina for a headbutt a client's move asked for and starts the cooldown if it is allowed. Server only */
+	bool ServerAcceptHeadbutt();
+
+	/** Opens the headbutt attack, called on the server by the movement component when the lunge starts */
+	void OnHeadbuttStarted();
+
+	/** Returns the tuning for an attack */
+	FORCEINLINE const FCowAttackKernel& GetAttackKernel(ECowAttack Attack) const { return ResolvedAttackTable->GetKernel(Attack); }
+
+	/** Whether the given attack should keep sweeping, checked by the combat component every tick */
+	bool IsAttackWindowOpen(ECowAttack Attack) const;
+
+	/** Applies stun, score and destruction for a single combat sweep hit. Returns false if the hit had no effect */
+	bool ApplyCombatHit(const FHitResult& Hit, ECowAttack Attack);
+
+	/** Whether one of the cow's montages is playing, read from the anim instance's flags rather than the montage system */
+	bool IsMontagePlaying(ECowMontage Montage) const;
+
+	/** Scales animation, shadows and audio to how much this cow matters to the local camera, called by UCowSignificanceSubsystem */
+	void ApplySignificance(const FCowSignificanceSettings& Settings);
+
 	/** Returns CameraBoom subobject **/
 	FORCEINLINE class USpringArmComponent* GetCameraBoom() const { return CameraBoom; }
 	/** Returns FollowCamera subobject **/
 	FORCEINLINE class UCameraComponent* GetFollowCamera() const { return FollowCamera; }
+	/** Returns CharacterMovement subobject as a UCowMovementComponent **/
+	FORCEINLINE UCowMovementComponent* GetCowMovement() const { return static_cast<UCowMovementComponent*>(GetCharacterMovement()); }
+	/** Returns CombatComponent subobject **/
+	FORCEINLINE UCowCombatComponent* GetCombatComponent() const { return CombatComponent; }
+	/** Returns LagCompensationComponent subobject **/
+	FORCEINLINE UCowLagCompensationComponent* GetLagCompensationComponent() const { return LagCompensationComponent; }
+	/** Returns NetPriorityComponent subobject **/
+	FORCEINLINE UCowNetPriorityComponent* GetNetPriorityComponent() const { return NetPriorityComponent; }
 };
 
@@ -2,14 +2,76 @@
 
 #include "MooMooMadnessGameMode.h"
 #include "MooMooMadnessCharacter.h"
-#include "UObject/ConstructorHelpers.h"
+#include "MooMooMadnessPlayerState.h"
+#include "MooMooMadnessGameState.h"
+#include "CowLeaderboardComponent.h"
+#include "GameFramework/DefaultPawn.h"
+#include "GameFramework/GameStateBase.h"
+#include "GameFramework/PlayerController.h"
 
 AMooMooMadnessGameMode::AMooMooMadnessGameMode()
 {
-	// set default pawn class to our Blueprinted character
-	static ConstructorHelpers::FClassFinder<APawn> PlayerPawnBPClass(TEXT("/Game/ThirdPerson/Blueprints/BP_Cow"));
-	if (PlayerPawnBPClass.Class != NULL)
+	PlayerStateClass = AMooMooMadnessPlayerState::StaticClass();
+	GameStateClass = AMooMooMadnessGameState::StaticClass();
+}
+
+void AMooMooMadnessGameMode::InitGame(const FString& MapName, const FString& Options, FString& ErrorMessage)
+{
+	Super::InitGame(MapName, Options, ErrorMessage);
+
+	//Match Blueprints set their own pawn, anything still on the engine default gets the configured cow
+	if (DefaultPawnClass == ADefaultPawn::StaticClass() && !CowPawnClass.IsNull())
+	{
+		DefaultPawnClass = CowPawnClass.LoadSynchronous();
+	}
+}
+
+void AMooMooMadnessGameMode::InitGameState()
+{
+	Super::InitGameState();
+
+	//GS_DestroyItAll and other Blueprint game states that don't derive from AMooMooMadnessGameState get the leaderboard here
+	if (GameState && !GameState->FindComponentByClass<UCowLeaderboardComponent>())
+	{
+		UCowLeaderboardComponent* Leaderboard = NewObject<UCowLeaderboardComponent>(GameState, TEXT("LeaderboardComponent"));
+		GameState->AddInstanceComponent(Leaderboard);
+		Leaderboard->RegisterComponent();
+	}
+}
+
+UCowLeaderboardComponent* AMooMooMadnessGameMode::GetLeaderboard() const
+{
+	return GameState ? GameState->FindComponentByClass<UCowLeaderboardComponent>() : nullptr;
+}
+
+void AMooMooMadnessGameMode::GenericPlayerInitialization(AController* C)
+{
+	Super::GenericPlayerInitialization(C);
+
+	//Runs for new logins and for players arriving by seamless travel, which skip PostLogin
+	UCowLeaderboardComponent* Leaderboard = GetLeaderboard();
+	const AMooMooMadnessPlayerState* CowPlayerState = C ? C->GetPlayerState<AMooMooMadnessPlayerState>() : nullptr;
+	if (Leaderboard && CowPlayerState)
+	{
+		Leaderboard->AddEntry(CowPlayerState->GetPlayerId(), CowPlayerState->GetPoints());
+	}
+}
+
+void AMooMooMadnessGameMode::Logout(AController* Exiting)
+{
+	UCowLeaderboardComponent* Leaderboard = GetLeaderboard();
+	if (Leaderboard && Exiting && Exiting->PlayerState)
+	{
+		Leaderboard->RemoveEntry(Exiting->PlayerState->GetPlayerId());
+	}
+
+	Super::Logout(Exiting);
+}
+
+void AMooMooMadnessGameMode::OnPlayerScored(AMooMooMadnessPlayerState* PlayerState, int32 Delta)
+{
+	if (UCowLeaderboardComponent* Leaderboard = GetLeaderboard())
 	{
-		DefaultPawnClass = PlayerPawnBPClass.Class;
+		Leaderboard->UpdateEntry(PlayerState->GetPlayerId(), PlayerState->GetPoints(), Delta);
 	}
 }
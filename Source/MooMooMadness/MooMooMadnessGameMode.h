@@ -6,6 +6,13 @@
 #include "GameFramework/GameModeBase.h"
 #include "MooMooMadnessGameMode.generated.h"
 
+class AMooMooMadnessPlayerState;
+class UCowLeaderboardComponent;
+
+/**
+ * Base for the match game modes. The cow pawn is never hard referenced from C++, the match Blueprints set it or it is
+ * loaded from CowPawnClass when the match starts, so the class default object doesn't pull the cow in at startup.
+ */
 UCLASS(minimalapi)
 class AMooMooMadnessGameMode : public AGameModeBase
 {
@@ -13,6 +20,22 @@ class AMooMooMadnessGameMode : public AGameModeBase
 
 public:
 	AMooMooMadnessGameMode();
+
+	virtual void InitGame(const FString& MapName, const FString& Options, FString& ErrorMessage) override;
+	virtual void InitGameState() override;
+	virtual void GenericPlayerInitialization(AController* C) override;
+	virtual void Logout(AController* Exiting) override;
+
+	/** Keeps the leaderboard in step with a player's score, called by the player state after it changes */
+	void OnPlayerScored(AMooMooMadnessPlayerState* PlayerState, int32 Delta);
+
+protected:
+	//Pawn for game modes whose Blueprint leaves DefaultPawnClass at the engine default
+	UPROPERTY(config)
+	TSoftClassPtr<APawn> CowPawnClass;
+
+private:
+	UCowLeaderboardComponent* GetLeaderboard() const;
 };
 
 
@@ -0,0 +1,11 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "MooMooMadnessGameState.h"
+
+#include "CowLeaderboardComponent.h"
+
+AMooMooMadnessGameState::AMooMooMadnessGameState()
+{
+	LeaderboardComponent = CreateDefaultSubobject<UCowLeaderboardComponent>(TEXT("LeaderboardComponent"));
+}
@@ -0,0 +1,30 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/GameStateBase.h"
+#include "MooMooMadnessGameState.generated.h"
+
+class UCowLeaderboardComponent;
+
+/**
+ * Match state shared with every client. Game state Blueprints should derive from this so the leaderboard is part of the
+ * class; AMooMooMadnessGameMode still adds one at runtime to game states that don't.
+ */
+UCLASS()
+class MOOMOOMADNESS_API AMooMooMadnessGameState : public AGameStateBase
+{
+	GENERATED_BODY()
+
+public:
+	AMooMooMadnessGameState();
+
+	/** Returns LeaderboardComponent subobject **/
+	FORCEINLINE UCowLeaderboardComponent* GetLeaderboardComponent() const { return LeaderboardComponent; }
+
+private:
+	/** Replicated leaderboard of every player's score */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Score, meta = (AllowPrivateAccess = "true"))
+	UCowLeaderboardComponent* LeaderboardComponent;
+};
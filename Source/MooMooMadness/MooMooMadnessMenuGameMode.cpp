@@ -0,0 +1,11 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "MooMooMadnessMenuGameMode.h"
+
+AMooMooMadnessMenuGameMode::AMooMooMadnessMenuGameMode()
+{
+	//The menu is all widgets, there is nothing to possess
+	DefaultPawnClass = nullptr;
+	bStartPlayersAsSpectators = true;
+}
@@ -0,0 +1,20 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/GameModeBase.h"
+#include "MooMooMadnessMenuGameMode.generated.h"
+
+/**
+ * Game mode for the main menu, mapped to L_MainMenu through GameModeMapPrefixes. Players only spectate, so nothing
+ * here references the cow, the match HUD or the match controller and the menu doesn't load them.
+ */
+UCLASS()
+class MOOMOOMADNESS_API AMooMooMadnessMenuGameMode : public AGameModeBase
+{
+	GENERATED_BODY()
+
+public:
+	AMooMooMadnessMenuGameMode();
+};
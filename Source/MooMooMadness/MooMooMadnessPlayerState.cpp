@@ -0,0 +1,53 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "MooMooMadnessPlayerState.h"
+
+#include "MooMooMadness.h"
+#include "MooMooMadnessGameMode.h"
+#include "Net/UnrealNetwork.h"
+
+void AMooMooMadnessPlayerState::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	FDoRepLifetimeParams Params;
+	Params.bIsPushBased = true;
+	DOREPLIFETIME_WITH_PARAMS_FAST(AMooMooMadnessPlayerState, Points, Params);
+}
+
+void AMooMooMadnessPlayerState::CopyProperties(APlayerState* PlayerState)
+{
+	Super::CopyProperties(PlayerState);
+
+	//Keeps the score across seamless travel and reconnects
+	if (AMooMooMadnessPlayerState* CowPlayerState = Cast<AMooMooMadnessPlayerState>(PlayerState))
+	{
+		CowPlayerState->SetPoints(Points);
+	}
+}
+
+void AMooMooMadnessPlayerState::AddPoints(int32 Delta)
+{
+	if (!HasAuthority() || Delta == 0) { return; }
+
+	SetPoints(Points + Delta);
+	if (AMooMooMadnessGameMode* GameMode = GetWorld()->GetAuthGameMode<AMooMooMadnessGameMode>())
+	{
+		GameMode->OnPlayerScored(this, Delta);
+	}
+}
+
+void AMooMooMadnessPlayerState::SetPoints(int32 NewPoints)
+{
+	if (NewPoints == Points) { return; }
+
+	const int32 OldPoints = Points;
+	SET_REPLICATED_PROPERTY(AMooMooMadnessPlayerState, Points, NewPoints);
+	OnPointsChanged.Broadcast(Points, Points - OldPoints);
+}
+
+void AMooMooMadnessPlayerState::OnRep_Points(int32 OldPoints)
+{
+	OnPointsChanged.Broadcast(Points, Points - OldPoints);
+}
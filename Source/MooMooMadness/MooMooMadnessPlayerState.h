@@ -0,0 +1,46 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/PlayerState.h"
+#include "MooMooMadnessPlayerState.generated.h"
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnCowPointsChanged, int32, NewPoints, int32, Delta);
+
+/**
+ * Holds a player's match score so it survives the pawn. Points only change on the server and replicate
+ * push based, so players whose score didn't change cost nothing on a net update.
+ * Uses its own Points instead of APlayerState::Score, which is push based too but is a float, and whose OnRep_Score
+ * doesn't get the old value, so OnPointsChanged couldn't pass the delta on clients.
+ */
+UCLASS()
+class MOOMOOMADNESS_API AMooMooMadnessPlayerState : public APlayerState
+{
+	GENERATED_BODY()
+
+public:
+	/** Adds Delta to the score. Server only */
+	UFUNCTION(BlueprintCallable, BlueprintAuthorityOnly, Category = "Score")
+	void AddPoints(int32 Delta);
+
+	UFUNCTION(BlueprintPure, Category = "Score")
+	FORCEINLINE int32 GetPoints() const { return Points; }
+
+	//Broadcast on the server and on every client whenever Points changes, scoreboards bind to this instead of polling
+	UPROPERTY(BlueprintAssignable, Category = "Score")
+	FOnCowPointsChanged OnPointsChanged;
+
+protected:
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+	virtual void CopyProperties(APlayerState* PlayerState) override;
+
+private:
+	void SetPoints(int32 NewPoints);
+
+	UFUNCTION()
+	void OnRep_Points(int32 OldPoints);
+
+	UPROPERTY(ReplicatedUsing = OnRep_Points)
+	int32 Points = 0;
+};
@@ -0,0 +1,154 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "MooMooMadnessReplicationGraph.h"
+
+#include "MooMooMadnessCharacter.h"
+#include "Destroyable.h"
+#include "ReplicationGraphTypes.h"
+#include "Engine/LevelScriptActor.h"
+#include "GameFramework/GameStateBase.h"
+#include "GameFramework/Info.h"
+#include "GameFramework/PlayerController.h"
+#include "GameFramework/PlayerState.h"
+
+void UMooMooMadnessReplicationGraph::InitGlobalActorClassSettings()
+{
+	Super::InitGlobalActorClassSettings();
+
+	//Explicit policies, every other class falls back to GetMappingPolicy when it first replicates
+	ClassRepNodePolicies.Set(AMooMooMadnessCharacter::StaticClass(), EMooRepNodeMapping::Spatialize_Dynamic);
+	ClassRepNodePolicies.Set(ADestroyable::StaticClass(), EMooRepNodeMapping::Spatialize_Static);
+	ClassRepNodePolicies.Set(AGameStateBase::StaticClass(), EMooRepNodeMapping::RelevantAllConnections);
+	ClassRepNodePolicies.Set(APlayerState::StaticClass(), EMooRepNodeMapping::RelevantAllConnections);
+	ClassRepNodePolicies.Set(APlayerController::StaticClass(), EMooRepNodeMapping::NotRouted);
+	ClassRepNodePolicies.Set(ALevelScriptActor::StaticClass(), EMooRepNodeMapping::NotRouted);
+
+	FClassReplicationInfo CowInfo;
+	InitClassReplicationInfo(CowInfo, AMooMooMadnessCharacter::StaticClass(), true);
+	GlobalActorReplicationInfoMap.SetClassInfo(AMooMooMadnessCharacter::StaticClass(), CowInfo);
+
+	FClassReplicationInfo DestroyableInfo;
+	InitClassReplicationInfo(DestroyableInfo, ADestroyable::StaticClass(), true);
+	//Props are static and dormant, the graph owns how far away they stay relevant rather than each Blueprint
+	DestroyableInfo.SetCullDistanceSquared(FMath::Square(DestroyableCullDistance));
+	GlobalActorReplicationInfoMap.SetClassInfo(ADestroyable::StaticClass(), DestroyableInfo);
+
+	FClassReplicationInfo GameStateInfo;
+	InitClassReplicationInfo(GameStateInfo, AGameStateBase::StaticClass(), false);
+	GlobalActorReplicationInfoMap.SetClassInfo(AGameStateBase::StaticClass(), GameStateInfo);
+
+	FClassReplicationInfo PlayerStateInfo;
+	InitClassReplicationInfo(PlayerStateInfo, APlayerState::StaticClass(), false);
+	GlobalActorReplicationInfoMap.SetClassInfo(APlayerState::StaticClass(), PlayerStateInfo);
+}
+
+void UMooMooMadnessReplicationGraph::InitGlobalGraphNodes()
+{
+	GridNode = CreateNewNode<UReplicationGraphNode_GridSpatialization2D>();
+	GridNode->CellSize = GridCellSize;
+	GridNode->SpatialBias = SpatialBias;
+	AddGlobalGraphNode(GridNode);
+
+	AlwaysRelevantNode = CreateNewNode<UReplicationGraphNode_ActorList>();
+	AddGlobalGraphNode(AlwaysRelevantNode);
+}
+
+void UMooMooMadnessReplicationGraph::InitConnectionGraphNodes(UNetReplicationGraphConnection* RepGraphConnection)
+{
+	Super::InitConnectionGraphNodes(RepGraphConnection);
+
+	//Gathers the connection's own player controller and view target
+	UReplicationGraphNode_AlwaysRelevant_ForConnection* ConnectionNode = CreateNewNode<UReplicationGraphNode_AlwaysRelevant_ForConnection>();
+	AddConnectionGraphNode(ConnectionNode, RepGraphConnection);
+}
+
+void UMooMooMadnessReplicationGraph::RouteAddNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo, FGlobalActorReplicationInfo& GlobalInfo)
+{
+	switch (GetMappingPolicy(ActorInfo.Class))
+	{
+		case EMooRepNodeMapping::RelevantAllConnections:
+			AlwaysRelevantNode->NotifyAddNetworkActor(ActorInfo);
+			break;
+
+		case EMooRepNodeMapping::Spatialize_Static:
+			//The grid cells move dormant actors in and out of their dormancy nodes as dormancy changes
+			GridNode->AddActor_Static(ActorInfo, GlobalInfo);
+			break;
+
+		case EMooRepNodeMapping::Spatialize_Dynamic:
+			GridNode->AddActor_Dynamic(ActorInfo, GlobalInfo);
+			break;
+
+		default:
+			break;
+	}
+}
+
+void UMooMooMadnessReplicationGraph::RouteRemoveNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo)
+{
+	switch (GetMappingPolicy(ActorInfo.Class))
+	{
+		case EMooRepNodeMapping::RelevantAllConnections:
+			AlwaysRelevantNode->NotifyRemoveNetworkActor(ActorInfo);
+			break;
+
+		case EMooRepNodeMapping::Spatialize_Static:
+			GridNode->RemoveActor_Static(ActorInfo);
+			break;
+
+		case EMooRepNodeMapping::Spatialize_Dynamic:
+			GridNode->RemoveActor_Dynamic(ActorInfo);
+			break;
+
+		default:
+			break;
+	}
+}
+
+void UMooMooMadnessReplicationGraph::SetActorNetUpdateFrequency(AActor* Actor, float Frequency)
+{
+	if (FGlobalActorReplicationInfo* GlobalInfo = GlobalActorReplicationInfoMap.Find(Actor))
+	{
+		GlobalInfo->Settings.ReplicationPeriodFrame = GetReplicationPeriodFrameForFrequency(Frequency);
+	}
+}
+
+EMooRepNodeMapping UMooMooMadnessReplicationGraph::GetMappingPolicy(UClass* Class)
+{
+	if (const EMooRepNodeMapping* Policy = ClassRepNodePolicies.Get(Class))
+	{
+		return *Policy;
+	}
+
+	//Classes without an explicit policy are routed the way default relevancy would treat them, then cached
+	const AActor* ActorCDO = GetDefault<AActor>(Class);
+	EMooRepNodeMapping Policy = EMooRepNodeMapping::Spatialize_Dynamic;
+	if (ActorCDO->bOnlyRelevantToOwner)
+	{
+		Policy = EMooRepNodeMapping::NotRouted;
+	}
+	else if (ActorCDO->bAlwaysRelevant || ActorCDO->IsA<AInfo>())
+	{
+		Policy = EMooRepNodeMapping::RelevantAllConnections;
+	}
+	else if (!ActorCDO->GetRootComponent() || ActorCDO->GetRootComponent()->Mobility == EComponentMobility::Static)
+	{
+		Policy = EMooRepNodeMapping::Spatialize_Static;
+	}
+
+	ClassRepNodePolicies.Set(Class, Policy);
+	return Policy;
+}
+
+void UMooMooMadnessReplicationGraph::InitClassReplicationInfo(FClassReplicationInfo& Info, UClass* Class, bool bSpatialize) const
+{
+	const AActor* ActorCDO = GetDefault<AActor>(Class);
+	if (bSpatialize)
+	{
+		Info.SetCullDistanceSquared(ActorCDO->NetCullDistanceSquared);
+	}
+
+	//Replication graph runs at NetServerMaxTickRate, turn the class update frequency into a frame period
+	Info.ReplicationPeriodFrame = GetReplicationPeriodFrameForFrequency(ActorCDO->NetUpdateFrequency);
+}
@@ -0,0 +1,67 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ReplicationGraph.h"
+#include "MooMooMadnessReplicationGraph.generated.h"
+
+class UReplicationGraphNode_GridSpatialization2D;
+class UReplicationGraphNode_ActorList;
+class UReplicationGraphNode_AlwaysRelevant_ForConnection;
+
+/** Which graph node an actor class is routed to */
+enum class EMooRepNodeMapping : uint8
+{
+	NotRouted,				//Only replicated through a connection specific node, like player controllers
+	RelevantAllConnections,	//Game state, player states and other always relevant actors
+	Spatialize_Static,		//Never moves, hashed into the grid once. Dormant actors are skipped until they wake up
+	Spatialize_Dynamic,		//Moves, rehashed into the grid every frame
+};
+
+/**
+ * Replication graph for the farm levels. Cows are bucketed into a 2D grid so each connection only
+ * considers the cows in cells around its viewer, destroyables are static grid actors whose dormancy
+ * the grid cells track, and the game state and player states go to every connection.
+ */
+UCLASS(Transient, config=Engine)
+class MOOMOOMADNESS_API UMooMooMadnessReplicationGraph : public UReplicationGraph
+{
+	GENERATED_BODY()
+
+public:
+	virtual void InitGlobalActorClassSettings() override;
+	virtual void InitGlobalGraphNodes() override;
+	virtual void InitConnectionGraphNodes(UNetReplicationGraphConnection* RepGraphConnection) override;
+	virtual void RouteAddNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo, FGlobalActorReplicationInfo& GlobalInfo) override;
+	virtual void RouteRemoveNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo) override;
+
+	/** Overrides how often one actor is considered for replication, the graph ignores AActor::NetUpdateFrequency */
+	void SetActorNetUpdateFrequency(AActor* Actor, float Frequency);
+
+	//Size of a grid cell, cows further than a cell or two from a viewer are never considered for it
+	UPROPERTY(config)
+	float GridCellSize = 10000.f;
+
+	//Lowest corner of the play space, keeps grid coordinates positive
+	UPROPERTY(config)
+	FVector2D SpatialBias = FVector2D(-100000.f, -100000.f);
+
+	//Cull distance for every destroyable class, overrides the actors' NetCullDistanceSquared
+	UPROPERTY(config)
+	float DestroyableCullDistance = 15000.f;
+
+	UPROPERTY()
+	TObjectPtr<UReplicationGraphNode_GridSpatialization2D> GridNode;
+
+	UPROPERTY()
+	TObjectPtr<UReplicationGraphNode_ActorList> AlwaysRelevantNode;
+
+private:
+	EMooRepNodeMapping GetMappingPolicy(UClass* Class);
+
+	/** Fills the class replication info from the class defaults */
+	void InitClassReplicationInfo(FClassReplicationInfo& Info, UClass* Class, bool bSpatialize) const;
+
+	TClassMap<EMooRepNodeMapping> ClassRepNodePolicies;
+};
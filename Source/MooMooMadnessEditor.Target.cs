@@ -11,5 +11,11 @@ public class MooMooMadnessEditorTarget : TargetRules
 		DefaultBuildSettings = BuildSettingsVersion.V4;
 		IncludeOrderVersion = EngineIncludeOrderVersion.Unreal5_3;
 		ExtraModuleNames.Add("MooMooMadness");
+
+		//MARK_PROPERTY_DIRTY is compiled out without this
+		bWithPushModel = true;
+
+		//Lets the same build run legacy replication or Iris, see net.Iris.UseIrisReplication
+		bUseIris = true;
 	}
 }